@@ -2,104 +2,61 @@
 This file holds functions to deal with the binary data structure correctly (while freeing memory etc.). 
 The binary data structures holds as a linked list the machine code of the commeand coding.
 The machine code will later be translated to be the output of the assembler.
+While the .ob file is streamed (with --low-memory), the words are passed to the output as they are added instead.
 */
 
 #include "binary_data_structure.h"
 #include "external_data_structure.h"
+#include "output.h"
 #include "constants.h"
 
-/* Add word of R type to the binary code image */
-void add_R_row(int opcode, int rs, int rt, int rd, int funct)
+code_row_ptr data_head, data_tail;
+code_row_ptr code_head, code_tail;
+code_row_ptr free_code_rows = NULL; /* Rows freed by previous files, kept to be reused by the next ones */
+int included_files = 0;
+long * included_sizes = NULL; /* Size of every included file as the first pass found it, in the order of the lines */
+int included_size_count = 0, included_size_capacity = 0, next_included_size = 0;
+
+/*
+ * Returns an empty row with an allocated type string.
+ * Rows freed by a previous file are reused before allocating new ones.
+ */
+code_row_ptr new_code_row()
 {
-    unsigned int temp;
+    code_row_ptr code;
 
-    code_row_ptr last_row, code;
-    get_code_tail(&last_row);
-
-    code = (code_row_ptr)malloc(sizeof(code_row));
+    if (free_code_rows != NULL)
+    {
+        code = free_code_rows;
+        free_code_rows = free_code_rows->next;
+    }
+    else
+    {
+        code = (code_row_ptr)malloc(sizeof(code_row));
+        code->type = (char *)malloc(sizeof(char) * (TYPE_SIZE + 1));
+    }
     code->next = NULL;
     code->word = 0;
-
-    code->type = (char *)malloc(sizeof(char) * (TYPE_SIZE + 1));
-    strcpy(code->type, "word");
-
-    temp = opcode;
-    code->word |= (temp << 26);
-
-    temp = rs;
-    code->word |= (temp << 21);
-
-    temp = rt;
-    code->word |= (temp << 16);
-
-    temp = rd;
-    code->word |= (temp << 11);
-
-    temp = funct;
-    code->word |= (temp << 6);
-
-    temp = 0; /* Unused attribute */
-    code ->word |= (temp);
-
-    last_row->next = code;
-    progress_code_tail();
+    code->count = 1;
+    code->bytes = NULL;
+    return code;
 }
 
-/* Add word of I type to the binary code image */
-void add_I_row(int opcode, int rs, int rt, int immed)
+/* Add an encoded word of an instructive (see encoder.c) to the binary code image */
+void add_code_word(unsigned long word)
 {
-    int temp;
-
     code_row_ptr last_row, code;
-    get_code_tail(&last_row);
 
-    code = (code_row_ptr)malloc(sizeof(code_row));
-    code->next = NULL;
-    code->word = 0;
-
-    code->type = (char *)malloc(sizeof(char) * (TYPE_SIZE + 1));
-    strcpy(code->type, "word");
-
-    temp = opcode;
-    code->word |= (temp << 26);
-
-    temp = rs;
-    code->word |= (temp << 21);
-
-    temp = rt;
-    code->word |= (temp << 16);
-
-    temp = immed;
-    temp &= MASK_16_BITS; /* Take only the least significant 16 bits */
-    code->word |= (temp);
-
-    last_row->next = code;
-    progress_code_tail();
-}
-
-/* Add word of J type to the binary code image */
-void add_J_row(int opcode, int reg, int address)
-{
-    unsigned int temp;
-
-    code_row_ptr last_row, code;
+    if (output_streamed())
+    {
+        stream_code_word(word);
+        return;
+    }
     get_code_tail(&last_row);
 
-    code = (code_row_ptr)malloc(sizeof(code_row));
-    code->next = NULL;
-    code->word = 0;
-
-    code->type = (char *)malloc(sizeof(char) * (TYPE_SIZE + 1));
+    code = new_code_row();
     strcpy(code->type, "word");
-
-    temp = opcode;
-    code->word |= (temp << 26);
-
-    temp = reg;
-    code->word |= (temp << 25);
-
-    temp = address;
-    code->word |= (temp);
+    code->word = word;
 
     last_row->next = code;
     progress_code_tail();
@@ -113,13 +70,15 @@ void add_char_array(char * array)
     code_row_ptr last_row;
     get_data_tail(&last_row);
 
+    if (output_streamed())
+    {
+        for (i=0; i < strlen(array) + 1; i++)
+            spool_data_bytes(array[i], 1);
+        return;
+    }
     for (i=0; i < strlen(array) + 1; i++)
     {
-        code_row_ptr code = (code_row_ptr)malloc(sizeof(code_row));
-        code->next = NULL;
-        code->word = 0;
-
-        code->type = (char *)malloc(sizeof(char) * (TYPE_SIZE + 1));
+        code_row_ptr code = new_code_row();
         strcpy(code->type, "byte");
 
         code->word |= array[i];
@@ -138,13 +97,15 @@ void add_integer_array(long * array, char * type, int length)
     code_row_ptr last_row;
     get_data_tail(&last_row);
 
+    if (output_streamed())
+    {
+        for (i=0; i < length; i++)
+            spool_data_bytes(array[i], !strcmp(type, "word") ? 4 : !strcmp(type, "half_word") ? 2 : 1);
+        return;
+    }
     for (i=0; i < length; i++)
     {
-        code_row_ptr code = (code_row_ptr)malloc(sizeof(code_row));
-        code->next = NULL;
-        code->word = 0;
-
-        code->type = (char *)malloc(sizeof(char) * (strlen(type) + 1));
+        code_row_ptr code = new_code_row();
         strcpy(code->type, type);
         temp = array[i];
 
@@ -161,20 +122,96 @@ void add_integer_array(long * array, char * type, int length)
     }
 }
 
+/*
+ * Add a run of count equal words (.space / .fill) to the binary code image.
+ * The run is kept as a single row, and is only repeated when the output is made.
+ */
+void add_data_run(long value, char * type, long count)
+{
+    long i;
+    code_row_ptr last_row, code;
+
+    if (output_streamed())
+    {
+        for (i=0; i < count; i++)
+            spool_data_bytes(value, !strcmp(type, "word") ? 4 : !strcmp(type, "half_word") ? 2 : 1);
+        return;
+    }
+    get_data_tail(&last_row);
+
+    code = new_code_row();
+    strcpy(code->type, type);
+    if (!strcmp(type, "half_word"))
+        value &= MASK_16_BITS;
+    else if (!strcmp(type, "byte"))
+        value &= MASK_8_BITS;
+    code->word = value;
+    code->count = count;
+
+    last_row->next = code;
+    progress_data_tail();
+}
+
+/*
+ * Add the bytes of an included file (.incbin) to the binary code image, as a single row.
+ * The row owns the bytes (allocated with malloc), and frees them when the table is freed.
+ */
+void add_data_bytes(char * bytes, long length)
+{
+    code_row_ptr last_row, code;
+
+    included_files++;
+    if (output_streamed())
+    {
+        spool_data_block(bytes, length);
+        free(bytes);
+        return;
+    }
+    get_data_tail(&last_row);
+
+    code = new_code_row();
+    strcpy(code->type, "byte");
+    code->bytes = bytes;
+    code->count = length;
+
+    last_row->next = code;
+    progress_data_tail();
+}
+
+/*
+ * Keeps the size of a file included by the first pass (.incbin), so the second pass includes the same number of
+ * bytes even if the file changes in between (see next_kept_size).
+ */
+void keep_included_size(long size)
+{
+    if (included_size_count == included_size_capacity)
+    {
+        included_size_capacity = included_size_capacity ? 2 * included_size_capacity : 16;
+        included_sizes = (long *) realloc(included_sizes, included_size_capacity * sizeof(long));
+    }
+    included_sizes[included_size_count++] = size;
+}
+
+/* Returns the size the first pass found for the next file included by the second pass, -1 if there is none */
+long next_kept_size()
+{
+    return next_included_size < included_size_count ? included_sizes[next_included_size++] : -1;
+}
+
 void init_binary_tables()
 /* Function to initialize table for data image, code image, and external labels image */
 {
-    data_head = (code_row_ptr)malloc(sizeof(code_row));
+    included_files = 0;
+    included_size_count = 0;
+    next_included_size = 0;
+    data_head = new_code_row();
     data_tail = data_head;
-    data_tail->next = NULL;
 
-    code_head = (code_row_ptr)malloc(sizeof(code_row));
+    code_head = new_code_row();
     code_tail = code_head;
-    code_tail->next = NULL;
 
-    external_head = (external_row_ptr)malloc(sizeof(external_row));
+    external_head = new_external_row();
     external_tail = external_head;
-    external_tail->next = NULL;
 }
 
 void get_data_head_to_free(code_row_ptr* ptrhead)
@@ -220,18 +257,35 @@ void progress_code_tail(){
 
 void free_binary_table(code_row_ptr * head)
 {
+    /* Moves the whole table (including the dummy row) to the free rows, for the next file */
     code_row_ptr tmp;
-	tmp = (*head);
-    (*head) = (*head)->next;
-    free(tmp);
 
     while ((*head) != NULL)
     {
         tmp = (*head);
         (*head) = (*head)->next;
+        free(tmp->bytes);
+        tmp->bytes = NULL;
+        tmp->next = free_code_rows;
+        free_code_rows = tmp;
+    }
+}
+
+void release_code_rows()
+{
+    /* Frees the rows kept for reuse, once there are no more files to analyze */
+    code_row_ptr tmp;
+
+    while (free_code_rows != NULL)
+    {
+        tmp = free_code_rows;
+        free_code_rows = free_code_rows->next;
         free(tmp->type);
         free(tmp);
     }
+    free(included_sizes);
+    included_sizes = NULL;
+    included_size_capacity = 0;
 }
 
 
@@ -11,18 +11,23 @@ typedef struct binary_machine_code
     long word:32; /* The binary word */
     code_row_ptr next; /* Pointer to the next word struct */
     char * type; /* Type of the code inside, i.e 'word' / 'half_word' / 'byte' */
+    long count; /* Number of times the word is repeated - more than 1 only for .space and .fill */
+    char * bytes; /* The count bytes of an included file (.incbin) instead of a word, NULL for other rows */
 
 } code_row;
 
-code_row_ptr data_head, data_tail; /* Initialize data image head & tail */
-code_row_ptr code_head, code_tail; /* Initialize code image head & tail */
+extern code_row_ptr data_head, data_tail; /* Initialize data image head & tail */
+extern code_row_ptr code_head, code_tail; /* Initialize code image head & tail */
+extern int included_files; /* Number of files included (.incbin) in the data image of the current source */
 
-void add_R_row(int opcode, int rs, int rt, int rd, int funct);
-void add_I_row(int opcode, int rs, int rt, int immed);
-void add_J_row(int opcode, int reg, int address);
+void add_code_word(unsigned long word);
 
 void add_char_array(char * array);
 void add_integer_array(long * array, char * type, int numOfNums);
+void add_data_run(long value, char * type, long count);
+void add_data_bytes(char * bytes, long length);
+void keep_included_size(long size);
+long next_kept_size();
 
 void get_code_tail(code_row_ptr * ptrtail);
 void get_code_head(code_row_ptr * ptrhead);
@@ -34,7 +39,9 @@ void get_data_head(code_row_ptr * ptrhead);
 void get_data_head_to_free(code_row_ptr* ptrhead);
 void progress_data_tail();
 
+code_row_ptr new_code_row();
 void init_binary_tables();
 void free_binary_table(code_row_ptr * ptrhead);
+void release_code_rows();
 
 #endif
@@ -0,0 +1,36 @@
+/*
+This file holds the classes of the characters that the scanners of the passes test character by character.
+The table is fixed, so the classes are those of the C locale whatever locale the process runs in,
+and a test is a single lookup with no call.
+*/
+
+#include "char_class.h"
+
+#define A (CHAR_ALPHA | CHAR_LABEL | CHAR_PRINT) /* letter */
+#define D (CHAR_DIGIT | CHAR_LABEL | CHAR_PRINT) /* digit */
+#define W (CHAR_SPACE | CHAR_BLANK | CHAR_SEPARATOR | CHAR_PRINT) /* ' ' */
+#define B (CHAR_SPACE | CHAR_BLANK | CHAR_SEPARATOR) /* tab */
+#define S (CHAR_SPACE | CHAR_SEPARATOR) /* other white spaces */
+#define C (CHAR_SEPARATOR | CHAR_PRINT) /* ',' */
+#define E CHAR_SEPARATOR /* '\0' */
+#define P CHAR_PRINT /* other printable characters */
+
+const unsigned char char_classes[256] = {
+    E, 0, 0, 0, 0, 0, 0, 0, 0, B, S, S, S, S, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    W, P, P, P, P, P, P, P, P, P, P, P, C, P, P, P,
+    D, D, D, D, D, D, D, D, D, D, P, P, P, P, P, P,
+    P, A, A, A, A, A, A, A, A, A, A, A, A, A, A, A,
+    A, A, A, A, A, A, A, A, A, A, A, P, P, P, P, P,
+    P, A, A, A, A, A, A, A, A, A, A, A, A, A, A, A,
+    A, A, A, A, A, A, A, A, A, A, A, P, P, P, P, 0,
+    /* 128 - 255 are not in the C locale classes */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
@@ -0,0 +1,24 @@
+#ifndef CHAR_CLASS
+#define CHAR_CLASS
+
+/* Classes of characters, as bits of char_classes */
+#define CHAR_ALPHA 1 /* isalpha in the C locale */
+#define CHAR_DIGIT 2 /* isdigit */
+#define CHAR_SPACE 4 /* isspace in the C locale */
+#define CHAR_LABEL 8 /* a character a label may contain - a letter or a digit */
+#define CHAR_PRINT 16 /* isprint in the C locale */
+#define CHAR_SEPARATOR 32 /* a character that properly ends a number or a register - a white space, ',' or '\0' */
+#define CHAR_BLANK 64 /* a space or a tab, skipped between parameters */
+
+extern const unsigned char char_classes[256];
+
+#define CHAR_IS(ch, classes) (char_classes[(unsigned char) (ch)] & (classes))
+#define IS_ALPHA(ch) CHAR_IS(ch, CHAR_ALPHA)
+#define IS_DIGIT(ch) CHAR_IS(ch, CHAR_DIGIT)
+#define IS_SPACE(ch) CHAR_IS(ch, CHAR_SPACE)
+#define IS_LABEL_CHAR(ch) CHAR_IS(ch, CHAR_LABEL)
+#define IS_PRINT(ch) CHAR_IS(ch, CHAR_PRINT)
+#define IS_SEPARATOR(ch) CHAR_IS(ch, CHAR_SEPARATOR)
+#define IS_BLANK(ch) CHAR_IS(ch, CHAR_BLANK)
+
+#endif
@@ -5,6 +5,10 @@
 #define MASK_8_BITS  255 /* Mask to take only the 8 least significant bits with */
 #define MAX_LINE_LENGTH 80 /* Maximum allowed length of a line */
 #define INITIAL_ADDRESS 100 /* Initial address to count instrucitons from */
+#define MAX_BASE_ADDRESS 16777216 /* Highest base address, leaving room for code and data in a 25 bit address */
+#define MAX_DATA_RUN 16777216 /* Most bytes a single .space or .fill directive may take */
+#define MASK_25_BITS 33554431 /* Mask to take only the 25 least significant bits with - the address of a J instructive */
+#define MAX_ADDRESS MASK_25_BITS /* Highest address of the code and data, that a J instructive can hold */
 #define MAX_LABEL_LENGTH 32  /* Maximum allowed length of a label */
 #define MAX_ATTRIBUTE_LENGTH 11 /* Attribute can't be longer than 'code, entry' */
 #define ERROR 0 /* Error code */
@@ -22,4 +26,6 @@
 #define MAX_REGISTER_NUM 31
 #define MAX_IMMED 32768
 
+#define ASSEMBLER_VERSION "1.3" /* Changes whenever the output of the assembler changes */
+
 #endif
@@ -0,0 +1,149 @@
+/*
+This file collects the errors and warnings found in the file being analyzed.
+Diagnostics are kept in a buffer and written together once the file is done, instead of one printf each.
+With --max-errors N, the passes stop reading the file after its N-th error.
+Every diagnostic has a line, a column, a severity and a short code naming the kind of problem, and is written
+either as text ("In line 4: error: ...") or, with --diagnostics machine, as
+file:line:column:severity:code:message
+Every diagnostic is also kept as a record that holds neither the file name nor the format, so the warnings
+of a file taken from the cache (see output_cache.c) are written again as if the file was analyzed.
+*/
+
+#include "diagnostics.h"
+#include "options.h"
+
+char * diagnostics_file = NULL; /* Name of the file being analyzed */
+file_buffer diagnostics = {NULL, 0, 0, 0, NULL}; /* Diagnostics of the file not written yet */
+file_buffer records = {NULL, 0, 0, 0, NULL}; /* Diagnostics of the file, one "line column severity code word message" each */
+int diagnostics_errors = 0; /* Number of errors in the file */
+int diagnostics_quiet = 0; /* 1 while diagnostics are only noted and not written (see quiet_diagnostics) */
+char * quiet_code = NULL; /* Code of the first error reported while quiet, NULL if none */
+
+void start_diagnostics(char * file_name)
+{
+    diagnostics_file = file_name;
+    diagnostics.length = 0;
+    records.length = 0;
+    diagnostics_errors = 0;
+}
+
+/*
+ * Adds a diagnostic of the file, at the given line and column (0 if the column isn't known). The message is made of format and the arguments that follow it, as in printf,
+ * and ends with '\n'. line_word is the first word of the text form ("In" or "in"), kept as each message was printed before.
+ * Nothing is added once the file was stopped by --max-errors.
+ */
+void report(int line, int column, int severity, char * code, char * line_word, char * format, ...)
+{
+    char message[MAX_DIAGNOSTIC_LENGTH], text[MAX_DIAGNOSTIC_LENGTH + FILENAME_MAX + 64];
+    char record[MAX_RECORD_LENGTH];
+    char * severity_name = severity == DIAGNOSTIC_ERROR ? "error" : "warning";
+    va_list arguments;
+
+    if (diagnostics_quiet)
+    {
+        if (severity == DIAGNOSTIC_ERROR && quiet_code == NULL)
+            quiet_code = code;
+        return;
+    }
+    if (diagnostics_stopped())
+        return;
+    va_start(arguments, format);
+    vsprintf(message, format, arguments);
+    va_end(arguments);
+    if (options.diagnostics_format == MACHINE_DIAGNOSTICS)
+        sprintf(text, "%.*s:%d:%d:%s:%s:%s", FILENAME_MAX, diagnostics_file, line, column, severity_name, code, message);
+    else
+        sprintf(text, "%s line %d: %s: %s", line_word, line, severity_name, message);
+    append_string_to_buffer(&diagnostics, text);
+    sprintf(record, "%d %d %d %.32s %.8s %s", line, column, severity, code, line_word, message);
+    append_string_to_buffer(&records, record);
+    if (severity == DIAGNOSTIC_ERROR)
+        diagnostics_errors++;
+}
+
+/*
+ * Returns the records of the diagnostics of the file so far.
+ */
+file_buffer * diagnostic_records()
+{
+    return &records;
+}
+
+/*
+ * Adds the diagnostics kept in records (as returned by diagnostic_records) to the file being analyzed.
+ * A record that can't be read is skipped.
+ */
+void replay_diagnostics(char * kept, long length)
+{
+    char record[MAX_RECORD_LENGTH], code[MAX_RECORD_LENGTH], line_word[MAX_RECORD_LENGTH];
+    long start = 0, end;
+    int line, column, severity, n;
+
+    while (start < length)
+    {
+        for (end = start; end < length && kept[end] != '\n'; end++)
+            ;
+        if (end < length && end - start + 1 < MAX_RECORD_LENGTH)
+        {
+            memcpy(record, kept + start, end - start + 1);
+            record[end - start + 1] = '\0';
+            if (sscanf(record, "%d %d %d %s %s%n", &line, &column, &severity, code, line_word, &n) == 5
+                && record[n] == ' ' && strlen(record + n + 1) < MAX_DIAGNOSTIC_LENGTH
+                && (severity == DIAGNOSTIC_ERROR || severity == DIAGNOSTIC_WARNING))
+                report(line, column, severity, code, line_word, "%s", record + n + 1);
+        }
+        start = end + 1;
+    }
+}
+
+/*
+ * Makes the following diagnostics only noted, without formatting or keeping them (quiet is 1),
+ * or written as usual again (quiet is 0). Used to check single lines outside of a file (see encoder.c).
+ */
+void quiet_diagnostics(int quiet)
+{
+    diagnostics_quiet = quiet;
+    quiet_code = NULL;
+}
+
+/*
+ * Returns the code of the first error reported since diagnostics were made quiet, NULL if none.
+ */
+char * quiet_diagnostic_code()
+{
+    return quiet_code;
+}
+
+/*
+ * Returns 1 if the file reached the number of errors given to --max-errors, and shouldn't be read further.
+ */
+int diagnostics_stopped()
+{
+    return options.max_errors > 0 && diagnostics_errors >= options.max_errors;
+}
+
+/*
+ * Writes the diagnostics of the file to the standard output.
+ */
+void flush_diagnostics()
+{
+    char text[FILENAME_MAX + 64];
+
+    if (diagnostics_stopped())
+    {
+        if (options.diagnostics_format == MACHINE_DIAGNOSTICS)
+            sprintf(text, "%.*s:0:0:note:max-errors:stopped after %d errors\n", FILENAME_MAX, diagnostics_file, diagnostics_errors);
+        else
+            sprintf(text, "stopped after %d errors\n", diagnostics_errors);
+        append_string_to_buffer(&diagnostics, text);
+    }
+    if (diagnostics.length > 0)
+        fwrite(diagnostics.data, 1, diagnostics.length, stdout);
+    diagnostics.length = 0;
+}
+
+void release_diagnostics()
+{
+    free_file_buffer(&diagnostics);
+    free_file_buffer(&records);
+}
@@ -0,0 +1,24 @@
+#ifndef DIAGNOSTICS
+#define DIAGNOSTICS
+
+#include <stdio.h>
+#include <stdarg.h>
+#include "file_buffer.h"
+
+enum{DIAGNOSTIC_ERROR, DIAGNOSTIC_WARNING}; /* Severities of diagnostics */
+enum{TEXT_DIAGNOSTICS, MACHINE_DIAGNOSTICS}; /* Formats of diagnostics (--diagnostics text / machine) */
+
+#define MAX_DIAGNOSTIC_LENGTH 256 /* Longest message - a fixed text with a label or a number in it */
+#define MAX_RECORD_LENGTH (MAX_DIAGNOSTIC_LENGTH + 96) /* Longest record of a diagnostic - a message and its fields */
+
+void start_diagnostics(char * file_name);
+void report(int line, int column, int severity, char * code, char * line_word, char * format, ...);
+int diagnostics_stopped();
+void quiet_diagnostics(int quiet);
+char * quiet_diagnostic_code();
+file_buffer * diagnostic_records();
+void replay_diagnostics(char * kept, long length);
+void flush_diagnostics();
+void release_diagnostics();
+
+#endif
@@ -0,0 +1,453 @@
+/*
+This file is the disassembler - it turns images made by the assembler (or by the linker) back into instructives.
+Usage: disassembler [-j jobs] name...
+Every name is given as to the assembler, and its .ob file is read, with the labels of its .ent and .ext files
+(when they exist). A name that ends with .obj is read as a binary object file instead, with its own tables.
+The listing of every name is written to name.dis - a line for every code word, with its address, the word and
+the instructive, followed by the data, 4 bytes in a line. Entries are written as label definitions at their
+addresses, and an operand that points at an entry, or a word that uses an external label, gets the label's name.
+The decode table is made from get_opcode and get_funct, so it always matches the encoder - every word is decoded
+with a single lookup of its opcode and funct. The listing is made in memory and written at once.
+With -j, the names are split between that many processes, which disassemble them at the same time.
+*/
+
+#define _POSIX_C_SOURCE 200112L /* For fork and waitpid */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "constants.h"
+#include "file_buffer.h"
+#include "object_reader.h"
+#include "tokenizer.h"
+#include "encoder.h"
+
+#define NUMBER_OF_OPCODES 64
+#define NUMBER_OF_FUNCT_VALUES 32
+#define MAX_JOBS 64
+#define MAX_LISTING_LINE (2 * MAX_LINE_LENGTH) /* Longest line of a listing, with two labels in it */
+
+/* The instructive of every opcode and funct, ERR if there is none */
+int decode_table[NUMBER_OF_OPCODES][NUMBER_OF_FUNCT_VALUES];
+
+/* A label of a listing - a name and its address */
+typedef struct listing_label
+{
+    long address;
+    char * name;
+} listing_label;
+
+/* Labels of a listing of one kind, sorted by address once they are all read, so a label is found with a binary search */
+typedef struct label_table
+{
+    listing_label * rows;
+    long count, size; /* Number of labels, and of rows allocated */
+} label_table;
+
+/* Labels of a listing */
+typedef struct listing_labels
+{
+    label_table entries; /* The entries, defined at their addresses */
+    label_table externs; /* The external labels, at the addresses of the words that use them */
+} listing_labels;
+
+/* Fills the decode table, inverting the opcodes and functs of the encoder */
+void make_decode_table(void)
+{
+    int instructive, funct;
+
+    memset(decode_table, 0, sizeof(decode_table));
+    for (instructive = ADD; instructive <= STOP; instructive++)
+    {
+        if (instructive <= MVLO) /* only R instructives have a funct, the bits hold operands in the others */
+            decode_table[get_opcode(instructive)][get_funct(instructive)] = instructive;
+        else
+            for (funct = 0; funct < NUMBER_OF_FUNCT_VALUES; funct++)
+                decode_table[get_opcode(instructive)][funct] = instructive;
+    }
+}
+
+/* Adds name as a label at address to a table. Returns 1 on success, 0 if there is no memory for it */
+int add_listing_label(label_table * table, long address, char * name)
+{
+    listing_label * rows;
+
+    if (table->count == table->size)
+    {
+        rows = (listing_label *) realloc(table->rows, (2 * table->size + 1) * sizeof(listing_label));
+        if (rows == NULL)
+            return 0;
+        table->rows = rows;
+        table->size = 2 * table->size + 1;
+    }
+    table->rows[table->count].address = address;
+    table->rows[table->count++].name = name;
+    return 1;
+}
+
+/* Compares two labels by their addresses, for qsort */
+int compare_labels(const void * first, const void * second)
+{
+    long a = ((const listing_label *) first)->address, b = ((const listing_label *) second)->address;
+
+    return (a > b) - (a < b);
+}
+
+/* Sorts a table by address, after all of its labels were added */
+void sort_listing_labels(label_table * table)
+{
+    if (table->count > 1)
+        qsort(table->rows, table->count, sizeof(listing_label), compare_labels);
+}
+
+/* Returns the name of the label at address in a sorted table, NULL if there is none */
+char * find_listing_label(label_table * table, long address)
+{
+    long low = 0, high = table->count - 1, middle;
+
+    while (low <= high)
+    {
+        middle = low + (high - low) / 2;
+        if (table->rows[middle].address < address)
+            low = middle + 1;
+        else if (table->rows[middle].address > address)
+            high = middle - 1;
+        else
+            return table->rows[middle].name;
+    }
+    return NULL;
+}
+
+/*
+ * Reads the rows of a .ent or .ext file (a name and an address in a line) into a table of labels.
+ * The names are kept inside the buffer. Returns 1 on success, 0 if there is no memory for the labels.
+ */
+int read_label_file(label_table * table, file_buffer * buffer)
+{
+    char * line, * end;
+    long i;
+
+    append_to_buffer(buffer, "", 1); /* terminates the text */
+    for (i = 0; i < buffer->length - 1; i++)
+    {
+        line = buffer->data + i;
+        while (i < buffer->length - 1 && buffer->data[i] != ' ' && buffer->data[i] != '\n')
+            i++;
+        if (buffer->data[i] != ' ')
+            continue;
+        buffer->data[i] = '\0';
+        if (!add_listing_label(table, strtol(buffer->data + i + 1, &end, 10), line))
+            return 0;
+        i = end - buffer->data;
+        while (i < buffer->length - 1 && buffer->data[i] != '\n')
+            i++;
+    }
+    return 1;
+}
+
+/*
+ * The lines are put together in a local array with the functions below, which return the end of what they put,
+ * and then appended to the listing at once - formatting with sprintf took most of the time of the disassembler.
+ */
+
+/* Puts text at line */
+char * put_text(char * line, char * text)
+{
+    while (*text)
+        *line++ = *text++;
+    return line;
+}
+
+/* Puts a decimal number at line, with at least width digits (0 padded) */
+char * put_number(char * line, long number, int width)
+{
+    char digits[WORD];
+    int count = 0;
+    unsigned long value = number < 0 ? 0UL - (unsigned long) number : (unsigned long) number;
+
+    if (number < 0)
+        *line++ = '-';
+    do
+    {
+        digits[count++] = (char) ('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (width-- > count)
+        *line++ = '0';
+    while (count > 0)
+        *line++ = digits[--count];
+    return line;
+}
+
+/* Puts a register operand at line */
+char * put_register(char * line, int reg)
+{
+    *line++ = '$';
+    return put_number(line, reg, 1);
+}
+
+/* Puts the address and the word at the start of a line. The word is left blank for data lines */
+char * put_line_start(char * line, long address, unsigned long word, int code)
+{
+    int i;
+
+    line = put_number(line, address, 4);
+    *line++ = ' ';
+    for (i = 28; i >= 0; i -= 4)
+        *line++ = code ? "0123456789ABCDEF"[(word >> i) & 0xF] : ' ';
+    *line++ = ' ';
+    *line++ = ' ';
+    return line;
+}
+
+/* Puts the definition of the entry at address, if there is one */
+char * put_label_definition(char * line, listing_labels * labels, long address)
+{
+    char * label = find_listing_label(&labels->entries, address);
+
+    if (label)
+    {
+        line = put_text(line, label);
+        line = put_text(line, ": ");
+    }
+    return line;
+}
+
+/* Puts the name of the label at address, or the address itself if no entry is there */
+char * put_address(char * line, listing_labels * labels, long address)
+{
+    char * label = find_listing_label(&labels->entries, address);
+
+    return label ? put_text(line, label) : put_number(line, address, 1);
+}
+
+/* Appends the line of the code word at address */
+void append_code_line(file_buffer * out, listing_labels * labels, long address, unsigned long word)
+{
+    int instructive = decode_table[word >> 26][(word >> 6) & 0x1F];
+    int rs = (int) (word >> 21) & 0x1F, rt = (int) (word >> 16) & 0x1F, rd = (int) (word >> 11) & 0x1F;
+    long immed = (long) (word & MASK_16_BITS) - ((word & 0x8000UL) ? 2 * MAX_IMMED : 0);
+    char text[MAX_LISTING_LINE], * line = text, * label;
+
+    line = put_line_start(line, address, word, 1);
+    line = put_label_definition(line, labels, address);
+    if (instructive == ERR)
+    {
+        line = put_text(line, ".dw ");
+        line = put_number(line, (long) word, 1);
+    }
+    else
+    {
+        line = put_text(line, instructive_names[instructive]);
+        *line++ = ' ';
+    }
+
+    if (instructive >= ADD && instructive <= NOR)
+    {
+        line = put_text(put_register(line, rs), ", ");
+        line = put_text(put_register(line, rt), ", ");
+        line = put_register(line, rd);
+    }
+    else if (instructive >= MOVE && instructive <= MVLO)
+        line = put_register(put_text(put_register(line, rs), ", "), rd);
+    else if ((instructive >= ADDI && instructive <= NORI) || (instructive >= LB && instructive <= SH))
+    {
+        line = put_text(put_register(line, rs), ", ");
+        line = put_text(put_number(line, immed, 1), ", ");
+        line = put_register(line, rt);
+    }
+    else if (instructive >= BNE && instructive <= BGT)
+    {
+        line = put_text(put_register(line, rs), ", ");
+        line = put_text(put_register(line, rt), ", ");
+        line = put_address(line, labels, address + immed);
+    }
+    else if (instructive >= JMP && instructive <= CALL)
+    {
+        if (word & (1UL << 25)) /* jmp to the address in a register */
+            line = put_register(line, (int) (word & 0x1F));
+        else if ((label = find_listing_label(&labels->externs, address)) != NULL)
+            line = put_text(line, label);
+        else
+            line = put_address(line, labels, (long) (word & 0x1FFFFFFUL));
+    }
+    else if (instructive == STOP)
+        line--; /* no operands - remove the space after the name */
+    *line++ = '\n';
+    append_to_buffer(out, text, line - text);
+}
+
+/* Appends the lines of the data, 4 bytes in a line. A line also ends before an entry, so it starts a line of its own */
+void append_data_lines(file_buffer * out, listing_labels * labels, long address, unsigned char * data, long size)
+{
+    long i, count;
+    char text[MAX_LISTING_LINE], * line;
+
+    for (i = 0; i < size; i += count)
+    {
+        line = put_line_start(text, address + i, 0, 0);
+        line = put_label_definition(line, labels, address + i);
+        line = put_text(line, ".db");
+        for (count = 0; count < 4 && i + count < size &&
+                        (count == 0 || !find_listing_label(&labels->entries, address + i + count)); count++)
+        {
+            line = put_text(line, count == 0 ? " " : ", ");
+            line = put_number(line, (signed char) data[i + count], 1);
+        }
+        *line++ = '\n';
+        append_to_buffer(out, text, line - text);
+    }
+}
+
+/* Reads a file of a name with the given extension into buffer. Returns 1 on success, 0 otherwise */
+int load_name_file(file_buffer * buffer, char * name, char * extension)
+{
+    char * file_name = (char *) malloc(strlen(name) + strlen(extension) + 1);
+    int retval;
+
+    if (file_name == NULL)
+        return 0;
+    strcpy(file_name, name);
+    strcat(file_name, extension);
+    retval = load_file_buffer(buffer, file_name);
+    free(file_name);
+    return retval;
+}
+
+/* Disassembles name into name.dis. Returns 1 on success, 0 otherwise */
+int disassemble(char * name)
+{
+    file_buffer files[3], out;
+    object_image image;
+    listing_labels labels;
+    unsigned long i, address;
+    char * label, * file_name;
+    int length = strlen(name), retval = 1, valid = 0, binary = length > 4 && !strcmp(name + length - 4, ".obj");
+
+    for (i = 0; i < 3; i++)
+        init_file_buffer(&files[i]);
+    init_file_buffer(&out);
+    memset(&image, 0, sizeof(object_image));
+    if (!load_name_file(&files[0], name, binary ? "" : ".ob"))
+    {
+        printf("error: cannot read %s%s\n", name, binary ? "" : ".ob");
+        retval = 0;
+    }
+    else if (!binary && (valid = read_text_object(&image, &files[0])) == TEXT_OBJECT_NO_MEMORY)
+    {
+        printf("error: out of memory for the image of %s.ob\n", name);
+        retval = 0;
+    }
+    else if (binary ? !open_object_image(&image, (unsigned char *) files[0].data, files[0].length) : !valid)
+    {
+        printf("error: %s%s is not a valid object file\n", name, binary ? "" : ".ob");
+        retval = 0;
+    }
+    if (!retval)
+    {
+        free_file_buffer(&files[0]);
+        return 0;
+    }
+
+    /* the tables hold only the labels there are, so their size doesn't depend on the size of the image */
+    memset(&labels, 0, sizeof(listing_labels));
+    if (binary)
+    {
+        for (i = 0; i < image.entry_count && retval; i++)
+            if ((label = object_entry(&image, i, &address)) != NULL)
+                retval = add_listing_label(&labels.entries, address, label);
+        for (i = 0; i < image.extern_count && retval; i++)
+            if ((label = object_extern(&image, i, &address)) != NULL)
+                retval = add_listing_label(&labels.externs, address, label);
+        image.bytes = NULL; /* the image is inside the buffer, and is freed with it */
+    }
+    else
+    {
+        /* the .ent and .ext files are optional - a file without entries or external labels has none */
+        if (load_name_file(&files[1], name, ".ent"))
+            retval = read_label_file(&labels.entries, &files[1]);
+        if (retval && load_name_file(&files[2], name, ".ext"))
+            retval = read_label_file(&labels.externs, &files[2]);
+    }
+    sort_listing_labels(&labels.entries);
+    sort_listing_labels(&labels.externs);
+
+    if (!retval)
+        printf("error: out of memory for the labels of %s\n", name);
+    else
+    {
+        for (i = 0; i < image.code_size / 4; i++)
+            append_code_line(&out, &labels, image.base + 4 * i, read_object_word(image.code + 4 * i));
+        append_data_lines(&out, &labels, image.base + image.code_size, image.data, image.data_size);
+        if ((file_name = (char *) malloc(length + strlen(".dis") + 1)) == NULL)
+            retval = 0;
+        else
+        {
+            strcpy(file_name, name);
+            strcat(file_name, ".dis");
+            retval = write_file_buffer(&out, file_name);
+        }
+        if (!retval)
+            printf("error: cannot write %s.dis\n", name);
+        free(file_name);
+    }
+
+    free(labels.entries.rows);
+    free(labels.externs.rows);
+    free(image.bytes);
+    for (i = 0; i < 3; i++)
+        free_file_buffer(&files[i]);
+    free_file_buffer(&out);
+    return retval;
+}
+
+/* Disassembles every jobs-th name, from the job-th one. Returns 1 if all of them were disassembled, 0 otherwise */
+int disassemble_names(char ** names, int count, int job, int jobs)
+{
+    int i, retval = 1;
+
+    for (i = job; i < count; i += jobs)
+        if (!disassemble(names[i]))
+            retval = 0;
+    return retval;
+}
+
+int main(int argc, char *argv[])
+{
+    int first = 1, jobs = 1, job, status, retval = 1;
+    pid_t pid;
+
+    if (argc > 2 && !strcmp(argv[1], "-j"))
+    {
+        jobs = (int) strtol(argv[2], NULL, 10);
+        first = 3;
+    }
+    if (argc - first < 1 || jobs < 1 || jobs > MAX_JOBS)
+    {
+        printf("Usage: disassembler [-j jobs] name...\n");
+        return 1;
+    }
+
+    make_decode_table();
+    if (jobs > argc - first)
+        jobs = argc - first;
+    if (jobs == 1)
+        return disassemble_names(argv + first, argc - first, 0, 1) ? 0 : 1;
+
+    fflush(stdout);
+    for (job = 0; job < jobs; job++)
+    {
+        pid = fork();
+        if (pid == 0)
+            exit(disassemble_names(argv + first, argc - first, job, jobs) ? 0 : 1);
+        if (pid < 0 && !disassemble_names(argv + first, argc - first, job, jobs)) /* no process - do it here */
+            retval = 0;
+    }
+    while (wait(&status) > 0)
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            retval = 0;
+    return retval ? 0 : 1;
+}
@@ -0,0 +1,181 @@
+/*
+This file encodes single instructives into their 32 bit words.
+The second pass encodes every instructive of the file through encode_tokens, with the symbol table as
+its label resolver. encode_instruction encodes a single line on its own - it checks the line with the same
+functions the first pass uses, and resolves labels with a callback - so instructives can be encoded
+without a file and without the code table.
+encode_instruction is not reentrant: the checks of the first pass look labels up in the global symbol table
+(through the intern pool), and the encoder makes the global diagnostics quiet while it checks the line.
+It must not run while a file is being analyzed, or from two threads at once.
+*/
+
+#include "encoder.h"
+#include "first_pass_utils.h"
+#include "diagnostics.h"
+
+/* Returns the word of an R instructive */
+unsigned long make_R_word(int opcode, int rs, int rt, int rd, int funct)
+{
+    unsigned long word = 0;
+
+    word |= ((unsigned long) opcode << 26);
+    word |= ((unsigned long) rs << 21);
+    word |= ((unsigned long) rt << 16);
+    word |= ((unsigned long) rd << 11);
+    word |= ((unsigned long) funct << 6);
+    return word; /* the 6 least significant bits are unused */
+}
+
+/* Returns the word of an I instructive */
+unsigned long make_I_word(int opcode, int rs, int rt, int immed)
+{
+    unsigned long word = 0;
+
+    word |= ((unsigned long) opcode << 26);
+    word |= ((unsigned long) rs << 21);
+    word |= ((unsigned long) rt << 16);
+    word |= ((unsigned long) immed & MASK_16_BITS); /* Take only the least significant 16 bits */
+    return word;
+}
+
+/* Returns the word of a J instructive */
+unsigned long make_J_word(int opcode, int reg, int address)
+{
+    unsigned long word = 0;
+
+    word |= ((unsigned long) opcode << 26);
+    word |= ((unsigned long) reg << 25);
+    word |= ((unsigned long) address & MASK_25_BITS); /* an address never reaches the reg bit */
+    return word;
+}
+
+/*
+ * the function gets an instructive, and returns the funct value according to it
+ * (specified in the course booklet)
+ */
+int get_funct(int instructive)
+{
+    int functs[NUMBER_OF_FUNCTS] = {0, 1, 2, 3, 4 ,5, 1, 2, 3};
+    return functs[instructive];
+}
+
+/*
+ * the function gets an instructive, and returns the opcode value according to it
+ * (specified in the course booklet)
+ */
+int get_opcode(int instructive)
+{
+    int op[NUMBER_OF_INSTRUCTIVES] = {0, 0, 0, 0, 0 ,0, 1, 1, 1, 10, 11, 12, 13, 14, 15, 16,
+                                      17, 18, 19, 20, 21, 22, 23, 24, 30, 31, 32, 63};
+    return op[instructive];
+}
+
+/*
+ * Resolves a label operand, and fills value with its value. Sets the error of result if the label doesn't exist.
+ * Returns the kind of the label.
+ */
+int resolve_operand(char * line, token * operand, label_resolver resolve, void * context, long * value, encoding * result)
+{
+    char label[MAX_LABEL_LENGTH + 1];
+
+    token_text(line, operand, label, sizeof(label));
+    *value = 0;
+    result->label_kind = resolve(label, context, value);
+    if (result->label_kind == LABEL_UNDEFINED)
+    {
+        result->error = ENCODE_UNDEFINED_LABEL;
+        result->code = "undefined-label";
+    }
+    return result->label_kind;
+}
+
+/*
+ * Encodes an instructive whose line was already checked and split into tokens.
+ * operands points to the first operand, and every other operand is two tokens after it (after a comma).
+ * address is the address of the instructive, used for the distance of a branch.
+ * The word is made even if a label is undefined, with 0 in the place of its value.
+ */
+encoding encode_tokens(char * line, token * operands, int instructive, long address,
+                       label_resolver resolve, void * context)
+{
+    encoding result;
+    int opcode = get_opcode(instructive);
+    long value;
+
+    result.word = 0;
+    result.error = ENCODE_OK;
+    result.code = NULL;
+    result.label_kind = LABEL_UNDEFINED;
+    if (instructive >= ADD && instructive <= NOR) /* R logical/arithmetical instructive */
+        result.word = make_R_word(opcode, operands[0].value, operands[2].value, operands[4].value, get_funct(instructive));
+    else if (instructive >= MOVE && instructive <= MVLO) /* R copy instructive */
+        result.word = make_R_word(opcode, operands[0].value, 0, operands[2].value, get_funct(instructive));
+    else if ((instructive >= ADDI && instructive <= NORI) || (instructive >= LB && instructive <= SH))
+        /* I arithmetic and memory instructives - $rs, immed, $rt */
+        result.word = make_I_word(opcode, operands[0].value, operands[4].value, operands[2].value);
+    else if (instructive >= BNE && instructive <= BGT) /* I branched instructive - $rs, $rt, label */
+    {
+        if (resolve_operand(line, &operands[4], resolve, context, &value, &result) == LABEL_EXTERNAL)
+        {
+            result.error = ENCODE_EXTERNAL_BRANCH;
+            result.code = "external-branch";
+            value = address;
+        }
+        else if (result.error != ENCODE_OK)
+            value = address;
+        /* the immed is the distance from the instructive to the label */
+        result.word = make_I_word(opcode, operands[0].value, operands[2].value, value - address);
+    }
+    else if (instructive >= JMP && instructive <= CALL)
+    {
+        if (operands[0].type == TOKEN_REGISTER) /* jmp to the address in a register */
+            result.word = make_J_word(opcode, 1, operands[0].value);
+        else
+        {
+            /* the address of an external label is only known when linking */
+            if (resolve_operand(line, &operands[0], resolve, context, &value, &result) == LABEL_EXTERNAL)
+                value = 0;
+            result.word = make_J_word(opcode, 0, value);
+        }
+    }
+    else if (instructive == STOP)
+        result.word = make_J_word(opcode, 0, 0);
+    return result;
+}
+
+/*
+ * Checks and encodes a single line holding one instructive (optionally after a label definition),
+ * with the same checks as the first pass. Nothing is printed - the code of the first error found
+ * is returned in the encoding. The line must not be longer than MAX_LINE_LENGTH.
+ * Uses the global symbol table and diagnostics (see above) - a label defined on the line is an error
+ * if the symbol table holds it already.
+ */
+encoding encode_instruction(char * line, long address, label_resolver resolve, void * context)
+{
+    encoding result;
+    token_line tokens;
+    int k = 0, gotLabel, instructive, valid;
+    char label[MAX_LABEL_LENGTH];
+
+    result.word = 0;
+    result.error = ENCODE_SYNTAX_ERROR;
+    result.label_kind = LABEL_UNDEFINED;
+    if (strlen(line) > MAX_LINE_LENGTH)
+    {
+        result.code = "line-too-long";
+        return result;
+    }
+    quiet_diagnostics(1);
+    valid = tokenize_line(line, &tokens) && read_label(line, &tokens, &k, label, &gotLabel)
+            && (instructive = read_instructive(line, &tokens, &k)) != ERR && process_instructive(line, &tokens, &k, instructive);
+    if (!valid && quiet_diagnostic_code() == NULL)
+        result.code = k == tokens.count ? "missing-instructive" : "unknown-instructive";
+    else
+        result.code = quiet_diagnostic_code();
+    quiet_diagnostics(0);
+    if (!valid)
+        return result;
+
+    k = tokens.tokens[0].type == TOKEN_LABEL_DEF;
+    return encode_tokens(line, &tokens.tokens[k + 1], instructive, address, resolve, context);
+}
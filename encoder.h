@@ -0,0 +1,35 @@
+#ifndef ENCODER
+#define ENCODER
+
+#include "tokenizer.h"
+
+/* Errors of an encoding */
+enum{ENCODE_OK, ENCODE_SYNTAX_ERROR, ENCODE_UNDEFINED_LABEL, ENCODE_EXTERNAL_BRANCH};
+/* Kinds of labels, as returned by a label resolver */
+enum{LABEL_UNDEFINED = -1, LABEL_CODE, LABEL_DATA, LABEL_EXTERNAL};
+
+/*
+ * Finds the value (address) of a label operand. context is passed as given to the encoder.
+ * Returns the kind of the label, LABEL_UNDEFINED if there is no such label.
+ */
+typedef int (*label_resolver)(char * label, void * context, long * value);
+
+typedef struct encoding
+{
+    unsigned long word; /* The 32 bit word of the instructive */
+    int error; /* ENCODE_OK, or the kind of error */
+    char * code; /* Diagnostic code of the error (as in diagnostics.c), NULL if there is no error */
+    int label_kind; /* Kind of the label operand, LABEL_UNDEFINED if the instructive has none */
+} encoding;
+
+unsigned long make_R_word(int opcode, int rs, int rt, int rd, int funct);
+unsigned long make_I_word(int opcode, int rs, int rt, int immed);
+unsigned long make_J_word(int opcode, int reg, int address);
+int get_opcode(int instructive);
+int get_funct(int instructive);
+
+encoding encode_tokens(char * line, token * operands, int instructive, long address,
+                       label_resolver resolve, void * context);
+encoding encode_instruction(char * line, long address, label_resolver resolve, void * context);
+
+#endif
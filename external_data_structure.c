@@ -1,23 +1,44 @@
 /*
 This file holds functions to deal correctly with the data structure (linked list) that holds external commands.
-It holds both the address of the command in memory and the name of the external variable.
+It holds both the address of the command in memory and the id of the name of the external variable in the intern pool.
 Later it will be put into an output file.
 */
 
 #include "external_data_structure.h"
+#include "intern_pool.h"
+
+external_row_ptr external_head, external_tail;
+external_row_ptr free_external_rows = NULL; /* Rows freed by previous files, kept to be reused */
+
+/*
+ * Returns an empty row.
+ * Rows freed by a previous file are reused before allocating new ones.
+ */
+external_row_ptr new_external_row()
+{
+    external_row_ptr row;
+
+    if (free_external_rows != NULL)
+    {
+        row = free_external_rows;
+        free_external_rows = free_external_rows->next;
+    }
+    else
+    {
+        row = (external_row_ptr)malloc(sizeof(external_row));
+    }
+    row->next = NULL;
+    return row;
+}
 
 void insert_external(char * symbol, long address)
 {
     /* Initialize new row*/
-    external_row_ptr new_row = (external_row_ptr)malloc(sizeof(external_row));
+    external_row_ptr new_row = new_external_row();
     external_row_ptr last_row;
-    int len_symbol;
 
-    len_symbol = strlen(symbol);
     get_external_tail(&last_row);
-
-    new_row->symbol = (char *) malloc(len_symbol+1);
-    strcpy(new_row->symbol, symbol);
+    new_row->id = intern_symbol(symbol);
 
     new_row->address = address;
 
@@ -50,16 +71,27 @@ void progress_external_tail()
 
 void free_external_table(external_row_ptr * head)
 {
+    /* Moves the whole table (including the dummy row) to the free rows, for the next file */
     external_row_ptr tmp;
-	tmp = (*head);
-    (*head) = (*head)->next;
-    free(tmp);
 
     while ((*head) != NULL)
     {
         tmp = (*head);
         (*head) = (*head)->next;
-        free(tmp->symbol);
+        tmp->next = free_external_rows;
+        free_external_rows = tmp;
+    }
+}
+
+void release_external_rows()
+{
+    /* Frees the rows kept for reuse, once there are no more files to analyze */
+    external_row_ptr tmp;
+
+    while (free_external_rows != NULL)
+    {
+        tmp = free_external_rows;
+        free_external_rows = free_external_rows->next;
         free(tmp);
     }
 }
@@ -11,17 +11,19 @@ typedef struct binary_external_code
 {
     int address; /* The address the external label was used*/
     external_row_ptr next; /* Pointer to the next word struct */
-    char * symbol; /* Name of the label defined as external */
+    int id; /* Id of the name of the label defined as external, in the intern pool */
 
 } external_row;
 
-external_row_ptr external_head, external_tail; /* Initialize external head & tail */
+extern external_row_ptr external_head, external_tail; /* Initialize external head & tail */
 
+external_row_ptr new_external_row();
 void progress_external_tail();
 void get_external_tail(external_row_ptr* ptrtail);
 void get_external_head(external_row_ptr* ptrhead);
 void insert_external(char * symbol, long address);
 void free_external_table(external_row_ptr* ptrhead);
 void get_external_head_to_free(external_row_ptr* ptrhead);
+void release_external_rows();
 
 #endif
@@ -0,0 +1,303 @@
+/*
+This file holds functions to deal with whole files kept in memory.
+Input files are read once into a buffer, and both passes read their lines from it instead of reading the disk twice.
+With --low-memory an input file is read line by line from the disk instead (see open_file_stream), so it is never
+held in memory as a whole.
+Output files are built in a buffer, and written to the disk with a single write when they are complete.
+*/
+
+#define _POSIX_C_SOURCE 200112L /* For posix_fadvise and getpid */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include "file_buffer.h"
+
+#define INITIAL_BUFFER_CAPACITY 4096 /* Capacity of a buffer on its first allocation */
+#define TEMP_SUFFIX_LENGTH 32 /* Upper bound for the length of the suffix of temporary file names */
+
+void init_file_buffer(file_buffer * buffer)
+{
+    buffer->data = NULL;
+    buffer->length = 0;
+    buffer->capacity = 0;
+    buffer->position = 0;
+    buffer->file = NULL;
+}
+
+/* Makes sure the buffer can hold extra more bytes. Returns 1 on success, 0 if out of memory */
+int reserve_buffer(file_buffer * buffer, long extra)
+{
+    long capacity = buffer->capacity;
+    char * data;
+
+    if (buffer->length + extra <= capacity)
+        return 1;
+    if (capacity == 0)
+        capacity = INITIAL_BUFFER_CAPACITY;
+    while (capacity < buffer->length + extra)
+        capacity *= 2;
+
+    data = (char *) realloc(buffer->data, capacity);
+    if (data == NULL)
+        return 0;
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return 1;
+}
+
+/* Reads a whole file into the buffer. Returns 1 on success, 0 if the file couldn't be read */
+int load_file_buffer(file_buffer * buffer, char * file_name)
+{
+    FILE * file;
+    long size, read;
+
+    init_file_buffer(buffer);
+    file = fopen(file_name, "rb");
+    if (!file)
+        return 0;
+
+    /* Allocate the whole file at once when its size is known, and keep reading in case it grew */
+    if (fseek(file, 0, SEEK_END) == 0 && (size = ftell(file)) > 0)
+        reserve_buffer(buffer, size);
+    rewind(file);
+
+    do
+    {
+        if (!reserve_buffer(buffer, INITIAL_BUFFER_CAPACITY))
+        {
+            fclose(file);
+            free_file_buffer(buffer);
+            return 0;
+        }
+        read = fread(buffer->data + buffer->length, 1, buffer->capacity - buffer->length, file);
+        buffer->length += read;
+    } while (read > 0);
+
+    fclose(file);
+    return 1;
+}
+
+/* Returns the size of a file in bytes, -1 if it couldn't be opened or isn't a file that can be seeked */
+long file_size(char * file_name)
+{
+    FILE * file = fopen(file_name, "rb");
+    long size = -1;
+
+    if (!file)
+        return -1;
+    if (fseek(file, 0, SEEK_END) == 0)
+        size = ftell(file);
+    /* a directory can be opened and seeked on some systems, but not read */
+    rewind(file);
+    if (size > 0 && getc(file) == EOF)
+        size = -1;
+    fclose(file);
+    return size;
+}
+
+/*
+ * Reads length bytes of a file, starting at offset, into the buffer.
+ * Returns 1 on success, 0 if the file couldn't be read or is shorter than offset + length.
+ */
+int load_file_range(file_buffer * buffer, char * file_name, long offset, long length)
+{
+    FILE * file;
+
+    init_file_buffer(buffer);
+    file = fopen(file_name, "rb");
+    if (!file)
+        return 0;
+    if (fseek(file, offset, SEEK_SET) != 0 || !reserve_buffer(buffer, length))
+    {
+        fclose(file);
+        return 0;
+    }
+    buffer->length = fread(buffer->data, 1, length, file);
+    fclose(file);
+    if (buffer->length != length)
+    {
+        free_file_buffer(buffer);
+        return 0;
+    }
+    return 1;
+}
+
+/*
+ * Opens a file to be read line by line with buffer_get_line, without reading it into memory.
+ * rewind_file_buffer starts reading it again, and free_file_buffer closes it.
+ * Returns 1 on success, 0 if the file couldn't be opened.
+ */
+int open_file_stream(file_buffer * buffer, char * file_name)
+{
+    init_file_buffer(buffer);
+    buffer->file = fopen(file_name, "rb");
+    return buffer->file != NULL;
+}
+
+/*
+ * Hints the system that a file is about to be read, so it is read ahead from the disk
+ * while the current file is being assembled.
+ */
+void prefetch_file(char * file_name)
+{
+#ifdef POSIX_FADV_WILLNEED
+    FILE * file = fopen(file_name, "rb");
+    if (file)
+    {
+        posix_fadvise(fileno(file), 0, 0, POSIX_FADV_WILLNEED);
+        fclose(file);
+    }
+#endif
+}
+
+/* Reads the next line of a file opened with open_file_stream, as buffer_get_line does */
+int file_get_line(FILE * file, char * line, int size)
+{
+    int i = 0, ch = 0;
+
+    while (i < size - 1 && ch != '\n' && (ch = getc(file)) != EOF)
+        line[i++] = (char) ch;
+    line[i] = '\0';
+    return i > 0;
+}
+
+/*
+ * Reads the next line of the buffer into line, the same way fgets does - at most size-1 characters,
+ * including the '\n' if reached. Returns 1 if a line was read, 0 at the end of the buffer.
+ */
+int buffer_get_line(file_buffer * buffer, char * line, int size)
+{
+    int i = 0;
+    char ch;
+
+    if (buffer->file != NULL)
+        return file_get_line(buffer->file, line, size);
+    if (buffer->position >= buffer->length)
+        return 0;
+
+    while (i < size - 1 && buffer->position < buffer->length)
+    {
+        ch = buffer->data[buffer->position++];
+        line[i++] = ch;
+        if (ch == '\n')
+            break;
+    }
+    line[i] = '\0';
+    return 1;
+}
+
+/* Moves the read position past the next '\n' (or to the end of the buffer) */
+void buffer_skip_line(file_buffer * buffer)
+{
+    int ch;
+
+    if (buffer->file != NULL)
+        while ((ch = getc(buffer->file)) != EOF && ch != '\n');
+    else
+        while (buffer->position < buffer->length && buffer->data[buffer->position++] != '\n');
+}
+
+void rewind_file_buffer(file_buffer * buffer)
+{
+    if (buffer->file != NULL)
+        rewind(buffer->file);
+    buffer->position = 0;
+}
+
+void append_to_buffer(file_buffer * buffer, char * text, long length)
+{
+    if (length > 0 && reserve_buffer(buffer, length))
+    {
+        memcpy(buffer->data + buffer->length, text, length);
+        buffer->length += length;
+    }
+}
+
+void append_string_to_buffer(file_buffer * buffer, char * text)
+{
+    append_to_buffer(buffer, text, strlen(text));
+}
+
+/* Writes the buffer to a file. Returns 1 on success, 0 otherwise */
+int write_file_buffer(file_buffer * buffer, char * file_name)
+{
+    int retval = 1;
+    FILE * file = fopen(file_name, "w");
+
+    if (!file)
+        return 0;
+    if (buffer->length > 0 && fwrite(buffer->data, 1, buffer->length, file) != (size_t) buffer->length)
+        retval = 0;
+    if (fclose(file) != 0)
+        retval = 0;
+    return retval;
+}
+
+/*
+ * Checks if a file holds exactly the content of the buffer - first by its size, then byte by byte.
+ * Returns 1 if it does, 0 if the content differs or the file doesn't exist.
+ */
+int file_equals_buffer(file_buffer * buffer, char * file_name)
+{
+    int equal = 1;
+    long position = 0, read;
+    char chunk[INITIAL_BUFFER_CAPACITY];
+    FILE * file = fopen(file_name, "rb");
+
+    if (!file)
+        return 0;
+    if (fseek(file, 0, SEEK_END) != 0 || ftell(file) != buffer->length)
+        equal = 0;
+    else
+        rewind(file);
+    while (equal && position < buffer->length)
+    {
+        read = fread(chunk, 1, sizeof(chunk), file);
+        if (read <= 0 || position + read > buffer->length || memcmp(chunk, buffer->data + position, read) != 0)
+            equal = 0;
+        position += read;
+    }
+    fclose(file);
+    return equal;
+}
+
+/* Returns a newly allocated name for a temporary file, next to file_name, to be renamed into file_name when complete */
+char * temp_file_name(char * file_name)
+{
+    char * temp_name = (char *) malloc(strlen(file_name) + TEMP_SUFFIX_LENGTH);
+
+    sprintf(temp_name, "%s.%ld.tmp", file_name, (long) getpid());
+    return temp_name;
+}
+
+/*
+ * Writes the buffer to a file only if the file doesn't hold the same content already, so its modification
+ * time is kept when nothing changed. The new content is written to a temporary file and renamed into place,
+ * so the file is never seen partly written.
+ * Returns 1 on success (whether the file was written or not), 0 otherwise.
+ */
+int replace_file_buffer(file_buffer * buffer, char * file_name)
+{
+    int retval = 1;
+    char * temp_name;
+
+    if (file_equals_buffer(buffer, file_name))
+        return 1;
+
+    temp_name = temp_file_name(file_name);
+    if (!write_file_buffer(buffer, temp_name) || rename(temp_name, file_name) != 0)
+    {
+        remove(temp_name);
+        retval = 0;
+    }
+    free(temp_name);
+    return retval;
+}
+
+void free_file_buffer(file_buffer * buffer)
+{
+    if (buffer->file != NULL)
+        fclose(buffer->file);
+    free(buffer->data);
+    init_file_buffer(buffer);
+}
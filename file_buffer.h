@@ -0,0 +1,35 @@
+#ifndef FILE_BUFFER
+#define FILE_BUFFER
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+typedef struct file_buffer
+{
+    char * data; /* The bytes of the file */
+    long length; /* Number of bytes used in data */
+    long capacity; /* Number of bytes allocated for data */
+    long position; /* Read position, used when reading the buffer line by line */
+    FILE * file; /* File read line by line from the disk instead of being kept in data (see open_file_stream), NULL if none */
+} file_buffer;
+
+void init_file_buffer(file_buffer * buffer);
+int reserve_buffer(file_buffer * buffer, long extra);
+int load_file_buffer(file_buffer * buffer, char * file_name);
+long file_size(char * file_name);
+int load_file_range(file_buffer * buffer, char * file_name, long offset, long length);
+int open_file_stream(file_buffer * buffer, char * file_name);
+void prefetch_file(char * file_name);
+int buffer_get_line(file_buffer * buffer, char * line, int size);
+void buffer_skip_line(file_buffer * buffer);
+void rewind_file_buffer(file_buffer * buffer);
+void append_to_buffer(file_buffer * buffer, char * text, long length);
+void append_string_to_buffer(file_buffer * buffer, char * text);
+int write_file_buffer(file_buffer * buffer, char * file_name);
+int file_equals_buffer(file_buffer * buffer, char * file_name);
+char * temp_file_name(char * file_name);
+int replace_file_buffer(file_buffer * buffer, char * file_name);
+void free_file_buffer(file_buffer * buffer);
+
+#endif
@@ -9,15 +9,15 @@ In addition it fills the lable table for use in the second pass
 
 int firstLineNumber = 1;
 
-int first_pass(FILE * file)
+int first_pass(file_buffer * source)
 {
     int retval = 1;
 
     char line[MAX_LINE_LENGTH + 1];
     firstLineNumber = 1;
-    while (fgets(line, sizeof(line), file))
+    while (!diagnostics_stopped() && buffer_get_line(source, line, sizeof(line)))
     {
-        if (!analyze_line(line, file))
+        if (!analyze_line(line, source))
             retval = ERROR;
         firstLineNumber++;
     }
@@ -26,27 +26,26 @@ int first_pass(FILE * file)
 }
 
 
-int analyze_line(char* line, FILE * file)
+int analyze_line(char* line, file_buffer * source)
 {
-    int retval = 1, i = 0, gotLabel;
+    int retval = 1, k = 0, gotLabel; /* k - index of the next token to read */
     char label[MAX_LABEL_LENGTH];
-    if(!no_more_chars(line, &i) && line[i] != ';')  /* not an empty line or comment */
+    token_line tokens;
+    if(tokenize_line(line, &tokens))  /* not an empty line or comment */
     {
-		if(!check_line_length(line, file))
+		if(!check_line_length(line, source))
 	    	retval = ERR;
-        else if (!get_label(line, &i, label, &gotLabel))
+        else if (!read_label(line, &tokens, &k, label, &gotLabel))
             retval = ERR;
-        else if (gotLabel && no_more_chars(line, &i)) {
-            printf("In line %d: error: illegal command - line cannot contain only a label\n",
-                   first_get_line_number());
+        else if (gotLabel && k == tokens.count) {
+            report(first_get_line_number(), token_column(line, &tokens, k), DIAGNOSTIC_ERROR, "only-label", "In",
+                   "illegal command - line cannot contain only a label\n");
             retval = ERR;
         }
-        else if (line[i] == '.'){
-            i++;
-            retval = directive_check(line, &i, label, &gotLabel);
-        }
+        else if (line[tokens.tokens[k].start] == '.' || tokens.tokens[k].type == TOKEN_DIRECTIVE)
+            retval = directive_check(line, &tokens, &k, label, &gotLabel);
         else
-            retval = instructive_check(line, &i, label, &gotLabel);
+            retval = instructive_check(line, &tokens, &k, label, &gotLabel);
     }
     return retval;
 }
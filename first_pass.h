@@ -3,7 +3,6 @@
 
 #include <stdio.h>
 #include <string.h>
-#include <ctype.h>
 #include <math.h>
 #include <stdlib.h>
 
@@ -12,9 +11,10 @@
 #include "second_pass.h"
 #include "binary_data_structure.h"
 #include "label_data_structure.h"
+#include "file_buffer.h"
 
-int first_pass(FILE * file);
-int analyze_line(char* line, FILE * file);
+int first_pass(file_buffer * source);
+int analyze_line(char* line, file_buffer * source);
 
 int get_DC();
 int get_IC();
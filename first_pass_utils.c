@@ -6,10 +6,14 @@
 
 
 #include "first_pass_utils.h"
+#include "options.h"
+#include "string_pool.h"
 
 /*
  * Retval is short for return value, and is used numerous time in the code.
- * line[] holds the line read from the given file.
+ * line[] holds the line read from the given file, and tokens holds its tokens (see tokenizer.c).
+ * k is the index in tokens of the next token to read, and is moved past every token that is read,
+ * as the index in line was before the line was split into tokens.
 */
 
 
@@ -18,47 +22,69 @@
  * first read the directive received, and the uses process_directive
  * to continue processing the line. Prints errors if needed.
  */
-int directive_check(char * line, int *p,  char* label, int* gotLabel)
+int directive_check(char * line, token_line * tokens, int * k, char* label, int* gotLabel)
 {
     int retval = 1, directive;
+    token * t = &tokens->tokens[*k];
     /* gets the directive, and checks if it is valid */
-    if (!(directive = get_directive(line, p))) {
-        print_err("undefined directive name\n");
+    if (t->type != TOKEN_DIRECTIVE || !(directive = t->value) || next_to_token(line, tokens, *k)) {
+        print_err(t->start + t->length + 1, "unknown-directive", "undefined directive name\n");
         retval = ERR;
     }
         /* processes the rest of the line according to the directive read */
-    else if(!process_directive(line, p, directive, label, gotLabel))
+    else if(!process_directive(line, tokens, k, directive, label, gotLabel))
         retval = ERR;
     return retval;
 }
 
 
+/*
+ * Checks that bytes more bytes of code or data fit in the address space, after the code and data so far
+ * (the data is placed after the code, so the last byte is at IC + DC + bytes - 1).
+ * Prints an error message if not. Returns 1 if they fit, 0 otherwise.
+ */
+int address_space_check(int column, long bytes)
+{
+    if((long) get_IC() + get_DC() + bytes - 1 > MAX_ADDRESS) {
+        report(first_get_line_number(), column, DIAGNOSTIC_ERROR, "address-range", "In",
+               "no room for %ld more bytes - the code and data can't pass address %ld\n", bytes, (long) MAX_ADDRESS);
+        return ERR;
+    }
+    return 1;
+}
+
+
 /*
  * Processes the parameters of a directive according to the directive received.
  * Returns 1 if valid, 0 otherwise.
  */
-int process_directive(char* line, int* p, int directive, char* label, int* gotLabel)
+int process_directive(char* line, token_line * tokens, int * k, int directive, char* label, int* gotLabel)
 {
-    int retval = 0;
+    int retval = 0, column = token_end(line, &tokens->tokens[*k]) + 1;
+    (*k)++;
     /* check if the line is valid, and if it is and a label was received, inserts it to the table */
-    if (directive >= DB && directive <= ASCIZ) {
+    if (directive >= DB && directive <= INCBIN) {
         int dc = get_DC();
         if (directive == ASCIZ)     /* processes asciz directive */
-            retval = asciz_process(line, p);
+            retval = asciz_process(line, tokens, k, *gotLabel, &dc);
+        else if (directive == SPACE || directive == FILL)   /* processes space, fill directives */
+            retval = data_run_process(line, tokens, k, directive);
+        else if (directive == INCBIN)   /* processes incbin directive */
+            retval = incbin_process(line, tokens, k);
         else        /* processes db, dh, dw directives */
-            retval = data_storage_process(line, p, directive);
+            retval = data_storage_process(line, tokens, k, directive);
         if(retval && *gotLabel)
-            insert_symbol(label, dc, "data");
+            insert_symbol(label, DATA_SECTION, dc, "data");
     }
     else if (directive == EXTERN) {
         if (*gotLabel)
-            print_warning("a label was declared before external directive\n");
-        retval = extern_process(line, p);   /* processes extern directive */
+            print_warning(column, "label-before-extern", "a label was declared before external directive\n");
+        retval = extern_process(line, tokens, k);   /* processes extern directive */
     }
     else if (directive == ENTRY) {
         if (*gotLabel)
-            print_warning("a label was declared before entry directive\n");
-        retval = entry_process(line, p);    /* processes entry directive */
+            print_warning(column, "label-before-entry", "a label was declared before entry directive\n");
+        retval = entry_process(line, tokens, k);    /* processes entry directive */
     }
     return retval;
 }
@@ -67,26 +93,40 @@ int process_directive(char* line, int* p, int directive, char* label, int* gotLa
 
 /*
  * Analyzes asciz command - receives a string in the format "string".
+ * With --pool-strings, a labeled string that already has a copy in the data image (see string_pool.c)
+ * takes no memory, and dc is set to the offset of that copy for the label.
  * Prints error messages. returns 1 if valid, 0 otherwise.
  */
-int asciz_process(char* line, int* p)
+int asciz_process(char* line, token_line * tokens, int * k, int gotLabel, int* dc)
 {
     int retval = 1, strLength = 1; /* strLength - the length of the string */
-    if(no_more_chars(line, p))
-        print_err("missing string after asciz command\n");
-    else if(line[(*p)++] != '"') {
-        print_err("illegal start of string - should start with \"\n");
-        retval = ERR;
+    char string[MAX_LINE_LENGTH];
+    token * t = &tokens->tokens[*k];
+    if(*k == tokens->count) {
+        print_err(token_column(line, tokens, *k), "missing-string", "missing string after asciz command\n");
+        return ERR;
+    }
+    if(t->type != TOKEN_STRING) {
+        print_err(token_column(line, tokens, *k) + 1, "string-start", "illegal start of string - should start with \"\n");
+        return ERR;
     }
-    else if(!get_string(line, p, &strLength))	/* checks if the string received is valid */
+    if(!read_string(line, tokens, k, &strLength))	/* checks if the string received is valid */
         retval = ERR;
-    else if(!no_more_chars(line, p)) {
-        print_err("extraneous text after end of command\n");
+    else if(*k < tokens->count) {
+        print_err(token_column(line, tokens, *k), "extraneous-text", "extraneous text after end of command\n");
         retval = ERR;
     }
+    else if(!address_space_check(token_column(line, tokens, *k), strLength))
+        retval = ERR;
+    else if(gotLabel && options.pool_strings != NO_POOLING) {
+        token_text(line, t, string, sizeof(string));
+        /* only the first copy of the string takes memory */
+        if((*dc = pool_string(string, get_DC(), options.pool_strings == POOL_SUFFIXES)) == get_DC())
+            increment_DC_by(strLength);
+    }
     else
 	/* increments DC by the string length +1 - the memory needed to store the string */
-        increment_DC_by(strLength);	
+        increment_DC_by(strLength);
     return retval;
 }
 
@@ -96,7 +136,7 @@ int asciz_process(char* line, int* p)
  * Analyzes .db, .dh, .dw commands - receives numbers in the format - num1, num2  , ... , numN
  * Prints error messages. returns 1 if valid, 0 otherwise.
  */
-int data_storage_process(char* line, int* p, int directive)
+int data_storage_process(char* line, token_line * tokens, int * k, int directive)
 {
     /* numOfNums - holds the number of numbers read, size - memory size (in bits) to store each number */
     int retval = 1, numOfNums, size;
@@ -108,39 +148,163 @@ int data_storage_process(char* line, int* p, int directive)
     else if(directive == DH)
         size = HALF_WORD;
     /* gets the number of numbers read in order to calculate the memory needed */
-    numOfNums = get_numbers(line, p, numbers, size);
+    numOfNums = read_numbers(line, tokens, k, numbers, size);
     if(numOfNums <= 0){
         retval = ERR;
     }
+    else if(!address_space_check(token_column(line, tokens, *k), numOfNums*(size/8)))
+        retval = ERR;
     else
         /* increments DC by the memory size needed to store the numbers read */
         increment_DC_by(numOfNums*(size/8));
     return retval;
 }
 
+/*
+ * Analyzes .space and .fill commands - .space receives the number of bytes to reserve, and .fill receives
+ * three numbers in the format - count, size, value - count values of size bytes (1, 2 or 4) each.
+ * Prints error messages. returns 1 if valid, 0 otherwise.
+ */
+int data_run_process(char* line, token_line * tokens, int * k, int directive)
+{
+    /* numOfNums - holds the number of numbers read, size - memory size (in bytes) of each value */
+    int retval = 1, numOfNums, size = 1, column;
+    long numbers[MAX_LINE_LENGTH];
+    numOfNums = read_numbers(line, tokens, k, numbers, WORD);
+    column = token_column(line, tokens, *k);
+    if(numOfNums <= 0)
+        retval = ERR;
+    else if(directive == SPACE && numOfNums != 1) {
+        print_err(column, "space-operands", "space directive receives a single number of bytes\n");
+        retval = ERR;
+    }
+    else if(directive == FILL && numOfNums != 3) {
+        print_err(column, "fill-operands", "fill directive receives 3 numbers - count, size and value\n");
+        retval = ERR;
+    }
+    else if(directive == FILL && (size = numbers[1]) != 1 && size != 2 && size != 4) {
+        report(first_get_line_number(), column, DIAGNOSTIC_ERROR, "fill-size", "In",
+               "fill size %d is not 1, 2 or 4 bytes\n", size);
+        retval = ERR;
+    }
+    else if(numbers[0] <= 0 || numbers[0] > MAX_DATA_RUN / size) {
+        report(first_get_line_number(), column, DIAGNOSTIC_ERROR, "run-length", "In",
+               "count %ld is out of range - should be between 1 and %ld\n", numbers[0], (long) MAX_DATA_RUN / size);
+        retval = ERR;
+    }
+    /* the value must fit in size bytes, as the numbers of .db, .dh and .dw do */
+    else if(directive == FILL && labs(numbers[2]) > (long) pow(2.0, 8.0 * size - 1) - 1) {
+        report(first_get_line_number(), column, DIAGNOSTIC_ERROR, "number-range", "In",
+               "number %ld is out of range for this instructive\n", numbers[2]);
+        retval = ERR;
+    }
+    else if(!address_space_check(column, numbers[0]*size))
+        retval = ERR;
+    else
+        /* increments DC by the memory size needed to store the run */
+        increment_DC_by(numbers[0]*size);
+    return retval;
+}
+
+/*
+ * Analyzes incbin command - receives a file name in the format "path", optionally followed by
+ * the offset and the length of the part of the file to include - "path", offset, length.
+ * Only the size of the file is checked here, and its bytes are read by the second pass.
+ * Prints error messages. returns 1 if valid, 0 otherwise.
+ */
+int incbin_process(char* line, token_line * tokens, int * k)
+{
+    /* numOfNums - holds the number of numbers read after the file name, column - column of the file name */
+    int retval = 1, numOfNums = 0, strLength = 0, column = 0;
+    long numbers[MAX_LINE_LENGTH], size = -1, offset = 0, length = 0;
+    char path[MAX_LINE_LENGTH];
+    token * t = &tokens->tokens[*k];
+    if(*k == tokens->count) {
+        print_err(token_column(line, tokens, *k), "missing-string", "missing file name after incbin command\n");
+        return ERR;
+    }
+    if(t->type != TOKEN_STRING) {
+        print_err(token_column(line, tokens, *k) + 1, "string-start", "illegal start of string - should start with \"\n");
+        return ERR;
+    }
+    column = t->start + 1;
+    if(!read_string(line, tokens, k, &strLength))	/* checks if the file name received is valid */
+        retval = ERR;
+    /* reads the offset and the length, if there is a comma after the file name */
+    else if(*k < tokens->count && (!read_number_comma(line, tokens, k) || (numOfNums = read_numbers(line, tokens, k, numbers, WORD)) <= 0))
+        retval = ERR;
+    else if(numOfNums != 0 && numOfNums != 2) {
+        print_err(token_column(line, tokens, *k), "incbin-operands", "incbin directive receives an offset and a length after the file name\n");
+        retval = ERR;
+    }
+    else {
+        token_text(line, t, path, sizeof(path));
+#ifdef NO_INCBIN
+        /* a build that must not read files (the fuzz targets, see fuzz.c) includes none */
+        print_err(column, "incbin-disabled", "incbin is not available in this build\n");
+        retval = ERR;
+#else
+        if((size = file_size(path)) < 0) {
+            report(first_get_line_number(), column, DIAGNOSTIC_ERROR, "incbin-file", "In",
+                   "couldn't read included file %s\n", path);
+            retval = ERR;
+        }
+        else {
+            offset = numOfNums ? numbers[0] : 0;
+            length = numOfNums ? numbers[1] : size - offset;
+        }
+#endif
+    }
+    if(!retval)
+        return ERR;
+    column = token_column(line, tokens, *k);
+    if(offset < 0 || length <= 0 || offset + length > size) {
+        report(first_get_line_number(), column, DIAGNOSTIC_ERROR, "incbin-range", "In",
+               "no bytes at offset %ld and length %ld of included file %s, of %ld bytes\n", offset, length, path, size);
+        retval = ERR;
+    }
+    else if(length > MAX_DATA_RUN) {
+        report(first_get_line_number(), column, DIAGNOSTIC_ERROR, "run-length", "In",
+               "included length %ld is out of range - should be at most %ld\n", length, (long) MAX_DATA_RUN);
+        retval = ERR;
+    }
+    else if(!address_space_check(column, length))   /* checked before the file is accepted */
+        retval = ERR;
+    else {
+        /* the second pass reads the file again, and checks it still has this size */
+        keep_included_size(size);
+        /* increments DC by the number of bytes included */
+        increment_DC_by(length);
+    }
+    return retval;
+}
+
 /*
  * Analyzes extern command - receives a label. Prints error messages.
  * Prints error messages. returns 1 if valid, 0 otherwise.
  */
-int extern_process(char* line, int* p)
+int extern_process(char* line, token_line * tokens, int * k)
 {
-    int retval = 1;
+    int retval = 1, column = token_column(line, tokens, *k); /* column - column of the label */
     char label[MAX_LABEL_LENGTH];
-    if(no_more_chars(line, p)){
-        print_err("missing label after external instructive\n");
+    if(*k == tokens->count){
+        print_err(token_column(line, tokens, *k), "missing-label", "missing label after external instructive\n");
         retval = ERR;
     }
         /* prints error if the label read is not valid */
-    else if(!get_operand_label(line, p, label, 1))
+    else if(!read_operand_label(line, tokens, k, label, 1))
         retval = ERR;
         /* prints error messages if there are characters after end of command */
-    else if(!no_more_chars(line, p)){
-        print_err("extraneous text after end of command\n");
+    else if(*k < tokens->count){
+        print_err(token_column(line, tokens, *k), "extraneous-text", "extraneous text after end of command\n");
         retval = ERR;
     }
         /* if all is well, enters the label to symbol table with "external" attribute */
     else
-        insert_symbol(label, 0, "external");
+    {
+        insert_symbol(label, NO_SECTION, 0, "external");
+        add_global_extern(label, first_get_line_number(), column);
+    }
     return retval;
 }
 
@@ -149,22 +313,25 @@ int extern_process(char* line, int* p)
  * Analyzes entry command - receives a label, and makes sure it is valid.
  * Prints error messages. Returns 1 if valid, 0 otherwise.
  */
-int entry_process(char* line, int* p)
+int entry_process(char* line, token_line * tokens, int * k)
 {
-    int retval = 1;
+    int retval = 1, column = token_column(line, tokens, *k); /* column - column of the label */
     char label[MAX_LABEL_LENGTH];
-    if(no_more_chars(line, p)){
-        print_err("missing label after entry instructive\n");
+    if(*k == tokens->count){
+        print_err(token_column(line, tokens, *k), "missing-label", "missing label after entry instructive\n");
         retval = ERR;
     }
         /* prints error if the label read is not valid */
-    else if(!get_operand_label(line, p, label, 0))
+    else if(!read_operand_label(line, tokens, k, label, 0))
         retval = ERR;
         /* prints error message if there are characters after end of command */
-    else if(!no_more_chars(line, p)){
-        print_err("extraneous text after end of command\n");
+    else if(*k < tokens->count){
+        print_err(token_column(line, tokens, *k), "extraneous-text", "extraneous text after end of command\n");
         retval = ERR;
     }
+        /* the entry is added to the global index by the first pass, as externals are, so they are kept even if the file fails */
+    else
+        add_global_entry(label, first_get_line_number(), column);
     return retval;
 }
 
@@ -175,20 +342,24 @@ int entry_process(char* line, int* p)
  * Checks if the instructive is valid and enters label to the symbol table if received.
  * Returns 1 if valid, 0 otherwise. Prints error messages if needed.
 */
-int instructive_check(char * line, int * p, char* label, int* gotLabel)
+int instructive_check(char * line, token_line * tokens, int * k, char* label, int* gotLabel)
 {
     int retval = 1, instructive;
+    token * t = &tokens->tokens[*k];
     /* gets the instructive, and checks if it is valid */
-    if (!(instructive = get_instructive(line, p))) {
-        print_err("undefined instructive name or illegal label\n");
+    if (!(instructive = read_instructive(line, tokens, k))) {
+        print_err(t->type == TOKEN_MNEMONIC ? t->start + t->length + 1 : token_column(line, tokens, *k),
+                  "unknown-instructive", "undefined instructive name or illegal label\n");
         retval = ERR;
     }
         /* processes the instructive and checks the line is valid */
-    else if(!process_instructive(line, p, instructive))
+    else if(!process_instructive(line, tokens, k, instructive))
+        retval = ERR;
+    else if(!address_space_check(token_column(line, tokens, *k), 4))
         retval = ERR;
     else {
         if (*gotLabel) /* if a label was received, inserts it to the symbol table */
-            insert_symbol(label, get_IC(), "code");
+            insert_symbol(label, CODE_SECTION, get_IC() - options.base_address, "code");
         increment_IC(); /* increments IC by 4 for every valid instructive received */
     }
     return retval;
@@ -199,27 +370,27 @@ int instructive_check(char * line, int * p, char* label, int* gotLabel)
  * Processes the parameters of an instructive according to the instructive received.
  * returns 1 if valid, 0 otherwise.
  */
-int process_instructive(char* line, int* p, int instructive)
+int process_instructive(char* line, token_line * tokens, int * k, int instructive)
 {
     int retval = 0;
     if (instructive >= ADD && instructive <= NOR)    /* R logical/arithmetical instructive */
-        retval = R_arithmetic_process(line, p);
+        retval = R_arithmetic_process(line, tokens, k);
     else if (instructive >= MOVE && instructive <= MVLO) /* R copy instructive */
-        retval = R_copy_process(line, p);
+        retval = R_copy_process(line, tokens, k);
     else if (instructive >= ADDI && instructive <= NORI) /* I arithmetic instructive */
-        retval = I_arithmetic_process(line, p);
+        retval = I_arithmetic_process(line, tokens, k);
     else if (instructive >= BNE && instructive <= BGT) /* I branched instructive */
-        retval = I_branched_process(line, p);
+        retval = I_branched_process(line, tokens, k);
     else if (instructive >= LB && instructive <= SH) /* I memory instructive */
-        retval = I_memory_process(line, p);
+        retval = I_memory_process(line, tokens, k);
     else if (instructive == JMP) /* jmp instructive */
-        retval = Jmp_process(line, p);
+        retval = Jmp_process(line, tokens, k);
     else if (instructive >= LA && instructive <= CALL) /* la or call instructive */
-        retval = La_Call_process(line, p);
+        retval = La_Call_process(line, tokens, k);
     else if(instructive == STOP)
         retval = 1;
-    if(retval && !no_more_chars(line, p)) {
-        print_err("extraneous text after end of command\n");
+    if(retval && *k < tokens->count) {
+        print_err(token_column(line, tokens, *k), "extraneous-text", "extraneous text after end of command\n");
         retval = ERR;
     }
     return retval;
@@ -230,22 +401,35 @@ int process_instructive(char* line, int* p, int instructive)
  * I_memory_process, I_branched_process, I_arithmetic_process, R_arithmetic_process,
  * R_copy_process, Jmp_process and La_Call_process.
  */
+/*
+ * Checks that the instructive has a first parameter, that doesn't start with a comma.
+ * Prints error messages. returns 1 if valid, 0 otherwise.
+ */
+int first_parameter(char* line, token_line * tokens, int * k)
+{
+    int retval = 0;
+    if(*k == tokens->count)
+        print_err(token_column(line, tokens, *k), "missing-parameter", "missing parameter\n");
+    else if(tokens->tokens[*k].type == TOKEN_COMMA)
+        print_err(token_column(line, tokens, *k), "illegal-comma", "illegal comma\n");
+    else
+        retval = 1;
+    return retval;
+}
+
 /*
  * Analyzes lb, sb, lw, sw, lh, sh commands.
  * Gets parameters in the format - $register1  ,  immed,  $register2.
  * Prints error messages. returns 1 if valid, 0 otherwise.
  */
-int I_memory_process(char* line, int* p)
+int I_memory_process(char* line, token_line * tokens, int * k)
 {
-    int retval = 0;
-    if(no_more_chars(line,p))
-        print_err("missing parameter\n");
-    else if(line[*p] == ',')
-        print_err("illegal comma\n");
+    int retval = 0, valid;
+    if(!first_parameter(line, tokens, k));
         /* receives parameters according to the instructive */
-    else if(get_register(line, p) == -1);
-    else if(!next_parameter(line, p) || !valid_num(line, p, MAX_IMMED));
-    else if(!next_parameter(line, p) || (get_register(line, p) == -1));
+    else if(read_register(line, tokens, k) == -1);
+    else if(!read_comma(line, tokens, k) || (read_number(line, tokens, k, &valid, MAX_IMMED), !valid));
+    else if(!read_comma(line, tokens, k) || (read_register(line, tokens, k) == -1));
     else retval = 1;
     return retval;
 }
@@ -255,17 +439,14 @@ int I_memory_process(char* line, int* p)
  * Gets parameters in the format - $register1  ,  &register2,  $register3.
  * Prints error messages. returns 1 if valid, 0 otherwise.
  */
-int I_branched_process(char* line, int* p)
+int I_branched_process(char* line, token_line * tokens, int * k)
 {
     int retval = 0;
     char label[MAX_LABEL_LENGTH];
-    if(no_more_chars(line,p))
-        print_err("missing parameter\n");
-    else if(line[*p] == ',')
-        print_err("illegal comma\n");
-    else if(get_register(line, p) == -1);
-    else if(!next_parameter(line, p) || (get_register(line, p) == -1));
-    else if(!next_parameter(line, p) || !get_operand_label(line, p, label, 0));
+    if(!first_parameter(line, tokens, k));
+    else if(read_register(line, tokens, k) == -1);
+    else if(!read_comma(line, tokens, k) || (read_register(line, tokens, k) == -1));
+    else if(!read_comma(line, tokens, k) || !read_operand_label(line, tokens, k, label, 0));
     else retval = 1;
     return retval;
 }
@@ -275,16 +456,13 @@ int I_branched_process(char* line, int* p)
  * Gets parameters in the format - $register1  ,  immed,  $register3.
  * Prints error messages. returns 1 if valid, 0 otherwise.
  */
-int I_arithmetic_process(char* line, int* p)
+int I_arithmetic_process(char* line, token_line * tokens, int * k)
 {
-    int retval = 0;
-    if(no_more_chars(line,p))
-        print_err("missing parameter\n");
-    else if(line[*p] == ',')
-        print_err("illegal comma\n");
-    else if(get_register(line, p) == -1);
-    else if(!next_parameter(line, p) || !valid_num(line, p, MAX_IMMED));
-    else if(!next_parameter(line, p) || (get_register(line, p) == -1));
+    int retval = 0, valid;
+    if(!first_parameter(line, tokens, k));
+    else if(read_register(line, tokens, k) == -1);
+    else if(!read_comma(line, tokens, k) || (read_number(line, tokens, k, &valid, MAX_IMMED), !valid));
+    else if(!read_comma(line, tokens, k) || (read_register(line, tokens, k) == -1));
     else retval = 1;
     return retval;
 }
@@ -294,17 +472,14 @@ int I_arithmetic_process(char* line, int* p)
  * Gets parameters in the format - $register1  ,  &register2,  $register3.
  * Prints error messages. returns 1 if valid, 0 otherwise.
  */
-int R_arithmetic_process(char* line, int* p)
+int R_arithmetic_process(char* line, token_line * tokens, int * k)
 {
     int retval = 0;
-    if(no_more_chars(line,p))
-        print_err("missing parameter\n");
-    else if(line[*p] == ',')
-        print_err("illegal comma\n");
+    if(!first_parameter(line, tokens, k));
         /* receives parameters */
-    else if(get_register(line, p) == -1);
-    else if(!next_parameter(line, p) || (get_register(line, p) == -1));
-    else if(!next_parameter(line, p) || (get_register(line, p) == -1));
+    else if(read_register(line, tokens, k) == -1);
+    else if(!read_comma(line, tokens, k) || (read_register(line, tokens, k) == -1));
+    else if(!read_comma(line, tokens, k) || (read_register(line, tokens, k) == -1));
     else retval = 1;
     return retval;
 }
@@ -314,16 +489,13 @@ int R_arithmetic_process(char* line, int* p)
  * Gets parameters in the format - $register1  ,  &register2 .
  * Prints error messages. returns 1 if valid, 0 otherwise.
  */
-int R_copy_process(char* line, int* p)
+int R_copy_process(char* line, token_line * tokens, int * k)
 {
     int retval = 0;
-    if(no_more_chars(line,p))
-        print_err("missing parameter\n");
-    else if(line[*p] == ',')
-        print_err("illegal comma\n");
+    if(!first_parameter(line, tokens, k));
         /* receives parameters */
-    else if(get_register(line, p) == -1);
-    else if(!next_parameter(line, p) || (get_register(line, p) == -1));
+    else if(read_register(line, tokens, k) == -1);
+    else if(!read_comma(line, tokens, k) || (read_register(line, tokens, k) == -1));
     else retval = 1;
     return retval;
 }
@@ -332,17 +504,17 @@ int R_copy_process(char* line, int* p)
  * Analyzes jmp command - receives a label or a register. Prints error messages.
  * returns 1 if valid, 0 otherwise.
  */
-int Jmp_process(char* line, int* p)
+int Jmp_process(char* line, token_line * tokens, int * k)
 {
     int retval = 0;
     char label[MAX_LABEL_LENGTH];
-    if(no_more_chars(line,p))
-        print_err("missing parameter\n");
-    else if(line[*p] == '$') {
-        if(get_register(line, p) != -1)
+    if(*k == tokens->count)
+        print_err(token_column(line, tokens, *k), "missing-parameter", "missing parameter\n");
+    else if(line[tokens->tokens[*k].start] == '$') {
+        if(read_register(line, tokens, k) != -1)
             retval = 1;
     }
-    else if(get_operand_label(line, p, label, 0))
+    else if(read_operand_label(line, tokens, k, label, 0))
         retval = 1;
     return retval;
 }
@@ -351,284 +523,104 @@ int Jmp_process(char* line, int* p)
  * Analyzes la and call commands - receives a label. Prints error messages.
  * returns 1 if valid, 0 otherwise.
  */
-int La_Call_process(char* line, int* p)
+int La_Call_process(char* line, token_line * tokens, int * k)
 {
     int retval = 0;
     char label[MAX_LABEL_LENGTH];
-    if(no_more_chars(line,p))
-        print_err("missing parameter\n");
-    else if(get_operand_label(line, p, label, 0))
+    if(*k == tokens->count)
+        print_err(token_column(line, tokens, *k), "missing-parameter", "missing parameter\n");
+    else if(read_operand_label(line, tokens, k, label, 0))
         retval = 1;
     return retval;
 }
 
 /*
- * Functions that are used to read a directive or instructive from the line:
- * get_directive, directive_name, get_instructive, instructive_name
- */
-/*
- * Reads the directive from line.
- * Returns the directives number if valid, 0 otherwise. Prints error messages if needed.
- */
-int get_directive(char * line, int *p)
-{
-    int directive, j = 0; /* j - index in dirct_name */
-    char dirct_name[MAX_DIRCT_LENGTH+1]; /* dirct_name holds the directive name */
-    if(no_more_chars(line, p))
-        directive = ERR;
-    else
-    {
-        /* reads directive into dirct_name array */
-        while(j < MAX_DIRCT_LENGTH && isalpha(line[*p]))
-            dirct_name[j++] = line[(*p)++];
-        if(isspace(line[*p]) || line[*p] == '\0')
-        {
-            dirct_name[j] = '\0'; /* adding terminal to the directive name string */
-            directive = directive_name(dirct_name); /* gets the directive */
-        }
-        else
-            directive = ERR;
-    }
-    return directive;
-}
-
-/*
- * Reads the instructive from line.
- * Returns 1 if instructive is valid, 0 otherwise. Prints error messages if needed.
+ * Reads the instructive from the tokens - a mnemonic that is followed by a space or by the end of the line.
+ * Returns the instructive if valid, 0 otherwise. Doesn't print error messages.
  */
-int get_instructive(char * line, int *p)
+int read_instructive(char * line, token_line * tokens, int * k)
 {
-    int instructive, j = 0; /* j - index in inst_name */
-    char inst_name[MAX_INST_LENGTH+1];  /* inst_name holds the instructive name */
-    if(no_more_chars(line, p))
-        instructive = ERR;
-    else
-    {
-        /* reads instructive into inst_name array */
-        while(j < MAX_INST_LENGTH && isalpha(line[*p]))
-            inst_name[j++] = line[(*p)++];
-        if(isspace(line[*p]) || line[*p] == '\0')
-        {
-            inst_name[j] = '\0';    /* adding terminal to the directive name string */
-            instructive = instructive_name(inst_name); /* gets the instructive */
-        }
-        else
-            instructive = ERR;
-    }
-    return instructive;
-}
-
-/*
- * Compares the string received to all of the instructive names.
- * If valid returns the instructive received, otherwise returns 0.
-*/
-int instructive_name(char* temp)
-{
-    int instructive;
-    if(!(strcmp(temp, "add")))
-        instructive = ADD;
-    else if(!(strcmp(temp, "sub")))
-        instructive = SUB;
-    else if(!(strcmp(temp, "and")))
-        instructive = AND;
-    else if(!(strcmp(temp, "or")))
-        instructive = OR;
-    else if(!(strcmp(temp, "nor")))
-        instructive = NOR;
-    else if(!(strcmp(temp, "move")))
-        instructive = MOVE;
-    else if(!(strcmp(temp, "mvhi")))
-        instructive = MVHI;
-    else if(!(strcmp(temp, "mvlo")))
-        instructive = MVLO;
-    else if(!(strcmp(temp, "addi")))
-        instructive = ADDI;
-    else if(!(strcmp(temp, "subi")))
-        instructive = SUBI;
-    else if(!(strcmp(temp, "andi")))
-        instructive = ANDI;
-    else if(!(strcmp(temp, "ori")))
-        instructive = ORI;
-    else if(!(strcmp(temp, "nori")))
-        instructive = NORI;
-    else if(!(strcmp(temp, "bne")))
-        instructive = BNE;
-    else if(!(strcmp(temp, "beq")))
-        instructive = BEQ;
-    else if(!(strcmp(temp, "blt")))
-        instructive = BLT;
-    else if(!(strcmp(temp, "bgt")))
-        instructive = BGT;
-    else if(!(strcmp(temp, "lb")))
-        instructive = LB;
-    else if(!(strcmp(temp, "sb")))
-        instructive = SB;
-    else if(!(strcmp(temp, "lw")))
-        instructive = LW;
-    else if(!(strcmp(temp, "sw")))
-        instructive = SW;
-    else if(!(strcmp(temp, "lh")))
-        instructive = LH;
-    else if(!(strcmp(temp, "sh")))
-        instructive = SH;
-    else if(!(strcmp(temp, "jmp")))
-        instructive = JMP;
-    else if(!(strcmp(temp, "la")))
-        instructive = LA;
-    else if(!(strcmp(temp, "call")))
-        instructive = CALL;
-    else if(!(strcmp(temp, "stop")))
-        instructive = STOP;
-    else
-        instructive = ERR;
-    return instructive;
-}
-
-/*
- * Compares the string received to all of the directive names.
- * If valid, returns the directive received, otherwise returns 0.
-*/
-int directive_name(char* temp)
-{
-    int directive;
-    if(!(strcmp(temp, "db")))
-        directive = DB;
-    else if(!(strcmp(temp, "dw")))
-        directive = DW;
-    else if(!(strcmp(temp, "dh")))
-        directive = DH;
-    else if(!(strcmp(temp, "asciz")))
-        directive = ASCIZ;
-    else if(!(strcmp(temp, "entry")))
-        directive = ENTRY;
-    else if(!(strcmp(temp, "extern")))
-        directive = EXTERN;
-    else
-        directive = ERR;
-    return directive;
+    token * t = &tokens->tokens[*k];
+    if(*k == tokens->count || t->type != TOKEN_MNEMONIC || next_to_token(line, tokens, *k))
+        return ERR;
+    (*k)++;
+    return t->value;
 }
 
 
 /*
  * Functions used to read and store numbers:
- * get_numbers, get_first_number, get_num, next_num
+ * read_numbers, read_number, read_number_comma
 
  * Reads from the line all numbers until the end of the line (or an error) in the format above.
  * Size is a parameter holding the number of bits to represent each number with.
- * Returns the number of numbers read - -1 if not valid
+ * Returns the number of numbers read - 0 if not valid
  */
 
-int get_numbers(char line[], int * p, long numbers[], int size)
+int read_numbers(char line[], token_line * tokens, int * k, long numbers[], int size)
 {
     /* valid - 1 if a number read is valid, 0 otherwise*/
-    int retval = 1, valid;
+    int retval = 0, valid = 1;
     long num; /* num - value of current number read  */
     long maxNum = pow(2.0, (long)(size-1))-1; /* calculates the max value of each number */
-    /*  reads first number into array, and if valid enters condition   */
-    if(get_first_number(line, p, numbers, &valid, maxNum)){
-        /* reads numbers from line as long as they exist, and no error was encountered*/
-        while(!no_more_chars(line, p) && retval) {
-            if (!next_num(line, p))
-                retval = ERR;
-            else if (line[*p] == ',') {
-                print_err("multiple consecutive commas\n");
-                retval = ERR;
-            }
-            else {    /* if valid, puts the number that was read in number array*/
-                num = get_num(line, p, &valid, maxNum);
-                if (valid)
-                    numbers[retval++] = num;
-                else
-                    retval = ERR;
-            }
-        }
+    /* reads the first number, and if valid reads the numbers after it as long as they exist */
+    if(*k == tokens->count){
+        print_err(token_column(line, tokens, *k), "missing-numbers", "no numbers received as parameters\n");
+        valid = ERR;
     }
-    else
-        retval--;
-    return retval;
-}
-
-/*
- *  Reads the first number, and prints error messages if needed. Returns 1 if valid, 0 otherwise.
- */
-int get_first_number(char line[], int * p, long numbers[], int* valid, long maxNum)
-{
-    int retval = 1;
-    long num;
-    if(no_more_chars(line, p)){
-        print_err("no numbers received as parameters\n");
-        retval = ERR;
-    }
-    else if(line[*p] == ','){
-        print_err("illegal comma\n");
-        retval = ERR;
+    else if(tokens->tokens[*k].type == TOKEN_COMMA){
+        print_err(token_column(line, tokens, *k), "illegal-comma", "illegal comma\n");
+        valid = ERR;
     }
-    else {
-        num = get_num(line, p, valid, maxNum);
-        if (*valid)
-            numbers[0] = num;
-        else
-            retval = ERR;
+    while(valid && (retval == 0 || (*k < tokens->count && read_number_comma(line, tokens, k)))) {
+        num = read_number(line, tokens, k, &valid, maxNum);
+        if (valid)  /* if valid, puts the number that was read in number array*/
+            numbers[retval++] = num;
     }
-    return retval;
+    return (valid && *k == tokens->count) ? retval : ERR;
 }
 
 /*
- * Reads the next single number in line for read_set command and returns it.
+ * Reads the next single number from the tokens and returns it.
  * Prints error messages if needed. Gives valid value 1 if number is valid, 0 otherwise.
  */
-long get_num(char line[], int* p, int* valid, long maxNum)
-{
-    int j = 0;  /*  j - index in the current number */
-    long retNum;	/* retNum - the number read */
-    int  isNegative = 0;    /* holds the sign of the number */
-    char temp[MAX_LINE_LENGTH]; /* contains the number being read*/
-    char ch;        /* an assisting char */
-
-    if(line[*p] == '-') {
-        isNegative = 1;
-        (*p)++;
-    }
-    else if(line[*p] == '+')
-        (*p)++;
-    while(isdigit(temp[j] = ch = line[(*p)])){	/* while reads digits, puts them in temp[] */
-        j++;
-        (*p)++;
-    }
-    /* atol returns the value of a number in a string passed to it (as a long int) */
-    if(isspace(ch) || ch ==',' || ch == '\0') { /* a proper end of a number */
-        if((retNum = atol(temp)) > maxNum) { 	/* if number is out of range */
-			if(isNegative)
-				retNum = -retNum;
-            printf("In line %d: error: number %ld is out of range for this instructive\n",
-                   first_get_line_number(), retNum);
-            *valid = ERR;
-        }
-        else
-            *valid = 1;
-    }
-    else{	/* received a non digit character - invalid number */
-        print_err("invalid parameter - not an integer\n");
-        *valid = ERR;
+long read_number(char line[], token_line * tokens, int * k, int* valid, long maxNum)
+{
+    token * t = &tokens->tokens[*k];
+    *valid = ERR;
+    if(*k == tokens->count || t->type != TOKEN_INTEGER)
+        print_err(token_column(line, tokens, *k), "not-integer", "invalid parameter - not an integer\n");
+    /* a number must end with a space, a comma or the end of the line */
+    else if(next_to_token(line, tokens, *k) && tokens->tokens[*k + 1].type != TOKEN_COMMA)
+        print_err(token_column(line, tokens, *k + 1), "not-integer", "invalid parameter - not an integer\n");
+    else if(labs(t->value) > maxNum) 	/* if number is out of range */
+        report(first_get_line_number(), t->start + t->length + 1, DIAGNOSTIC_ERROR, "number-range", "In",
+               "number %ld is out of range for this instructive\n", t->value);
+    else {
+        *valid = 1;
+        (*k)++;
+        return t->value;	/* returns number read */
     }
-    if(isNegative)
-        retNum = -retNum;
-    return retNum;	/* returns number read */
+    return 0;
 }
 
 /*
- * Reads a comma, and proceeds to the next number (ignores white spaces).
+ * Reads a comma, and proceeds to the next number.
  * Prints error messages. returns 1 if valid, 0 otherwise.
  */
-int next_num(char line[], int* p)
+int read_number_comma(char line[], token_line * tokens, int * k)
 {
     int retval = 1;
-    if(line[(*p)++] != ','){    /* gets comma, if not prints error message */
-        print_err("missing comma\n");
+    if(tokens->tokens[*k].type != TOKEN_COMMA){    /* gets comma, if not prints error message */
+        print_err(token_column(line, tokens, *k) + 1, "missing-comma", "missing comma\n");
         retval = ERR;
     }
-    else if(no_more_chars(line, p)){
-        print_err("list of numbers cannot be terminated with a comma\n");
+    else if(++(*k) == tokens->count){
+        print_err(token_column(line, tokens, *k), "trailing-comma", "list of numbers cannot be terminated with a comma\n");
+        retval = ERR;
+    }
+    else if(tokens->tokens[*k].type == TOKEN_COMMA){
+        print_err(token_column(line, tokens, *k), "consecutive-commas", "multiple consecutive commas\n");
         retval = ERR;
     }
     return retval;	/* Returns 1 if all is well, 0 otherwise */
@@ -636,61 +628,58 @@ int next_num(char line[], int* p)
 
 /*
  * Functions used to read and check label in line:
- * get_operand_label, valid_operand_label, get_label and valid_label.
+ * read_operand_label, valid_operand_label, read_label and valid_label.
  *
  *
  * Reads an label as an operand of a command.
  * Returns 1 if label is valid, 0 otherwise. Prints error messages if needed.
  */
-int get_operand_label(char* line, int* p, char* label, int isExternal)
-{
-    int retval = 1, j = 0;       /* j - index in label*/
-    /* reads potential label into the array */
-    char ch;
-    if(isalpha(line[(*p)])){
-        /* reads the label into the array while reads digits or characters */
-        while(j < MAX_LABEL_LENGTH && (isalpha(line[*p]) || isdigit(line[*p])))
-            label[j++] = line[(*p)++];
-        if(j == MAX_LABEL_LENGTH) {
-            print_err("non valid label - too long\n");
+int read_operand_label(char* line, token_line * tokens, int * k, char* label, int isExternal)
+{
+    int retval = 1;
+    token * t = &tokens->tokens[*k];
+    if(*k < tokens->count && t->type == TOKEN_IDENTIFIER){
+        if(t->length >= MAX_LABEL_LENGTH) {
+            print_err(t->start + MAX_LABEL_LENGTH + 1, "label-too-long", "non valid label - too long\n");
             retval = ERR;
         }
             /* in case encountered non valid character */
-        else if(!isspace(ch = line[*p]) && ch != '\n' && ch != '\0'){
-            print_err("non valid label - contains characters that are not digits or alphabetic\n");
+        else if(next_to_token(line, tokens, *k)){
+            print_err(token_column(line, tokens, *k + 1), "label-characters", "non valid label - contains characters that are not digits or alphabetic\n");
             retval = ERR;
         }
         else {
-            label[j] = '\0'; /* adding terminal sign to the end of the string */
-            retval = valid_operand_label(label, isExternal); /* checks if the label is valid (not a saved word) */
+            token_text(line, t, label, MAX_LABEL_LENGTH);
+            retval = valid_operand_label(label, t->start + 1, isExternal); /* checks if the label is valid (not a saved word) */
+            (*k)++;
         }
     }
     else {
-        print_err("non valid label - doesn't start with a character\n");
+        print_err(token_column(line, tokens, *k), "label-start", "non valid label - doesn't start with a character\n");
         retval = ERR;
     }
     return retval;
 }
 
 /*
- * Checks if the label for the operand is valid.
+ * Checks if the label for the operand, at the given column, is valid.
  * Returns 1 if label is valid, 0 otherwise. Prints error messages if needed.
  */
-int valid_operand_label(char* label, int isExternal)
+int valid_operand_label(char* label, int column, int isExternal)
 {
     int retval = 1;
     /* if label is a saved word - non valid */
-    if(directive_name(label) || instructive_name(label)) {
-        printf("In line %d: error: non valid label - %s is a saved word\n",
-               first_get_line_number(), label);
+    if(directive_of(label, strlen(label)) || instructive_of(label, strlen(label))) {
+        report(first_get_line_number(), column, DIAGNOSTIC_ERROR, "saved-word", "In",
+               "non valid label - %s is a saved word\n", label);
         retval = ERR;
     }
     else if(symbol_exists(label)) {
         char attribute[MAX_ATTRIBUTE_LENGTH];
         get_symbol_attributes(label, attribute);
         if(isExternal && strcmp(attribute, "external")) {
-            printf("in line %d: error: %s was already declared as non external\n", 
-				first_get_line_number(), label);
+            report(first_get_line_number(), column, DIAGNOSTIC_ERROR, "not-external", "in",
+				"%s was already declared as non external\n", label);
             retval = ERR;
         }
     }
@@ -699,50 +688,47 @@ int valid_operand_label(char* label, int isExternal)
 
 
 /*
- * Reads a label (in the beginning of a command line).
+ * Reads a label (in the beginning of a command line), and moves k past it.
  * Returns 1 if label is valid, 0 otherwise. Prints error messages if needed.
  */
-int get_label(char* line, int* p, char* label, int* gotLabel)
+int read_label(char* line, token_line * tokens, int * k, char* label, int* gotLabel)
 {
-    int retval = 1, j = 0, i = (*p);       /* j - index in la, i index in line*/
-    /* reads potential label into the array */
+    int retval = 1, end;       /* end - index in line after the ':' of the label */
+    token * t = &tokens->tokens[*k];
     *gotLabel = 0;
-    if(isalpha(line[i])){
-        while(j < MAX_LABEL_LENGTH && (isalpha(line[i]) || isdigit(line[i])))
-            label[j++] = line[i++];
-        if(j == MAX_LABEL_LENGTH) {
-            print_err("Non valid start of command\n");
-            retval = ERR;
+    if((t->type == TOKEN_LABEL_DEF || t->type == TOKEN_MNEMONIC) && t->length >= MAX_LABEL_LENGTH) {
+        print_err(t->start + MAX_LABEL_LENGTH + 1, "label-too-long", "Non valid start of command\n");
+        retval = ERR;
+    }
+    else if(t->type == TOKEN_LABEL_DEF) {
+        end = t->start + t->length + 1;
+        if (IS_SPACE(line[end]) || line[end] == '\0') {
+            token_text(line, t, label, MAX_LABEL_LENGTH);
+            (*k)++; /* only of the word is a label, proceeds through the tokens */
+            *gotLabel = 1;
+            retval = valid_label(label, t->start + 1);    /* checks if the label is valid in case got a label */
         }
-        else if(line[i++] == ':') {
-            if (isspace(line[i]) || line[i] == '\0' || line[i] == '\n') {
-                label[j] = '\0'; /* adding terminal to the directive name string */
-                *p = i + 1; /* only of the word is a label, proceeds with index through the line */
-                *gotLabel = 1;
-                retval = valid_label(label);    /* checks if the label is valid in case got a label */
-            }
-            else {
-                print_err("Missing space after end of label\n");
-                retval = ERR;
-            }
+        else {
+            print_err(end + 1, "label-space", "Missing space after end of label\n");
+            retval = ERR;
         }
     }
     return retval;
 }
 
 /*
- * Checks if the label is valid (at the beginning of the line).
+ * Checks if the label at the given column is valid (at the beginning of the line).
  * Returns 1 if label is valid, 0 otherwise. Prints error messages if needed.
  */
-int valid_label(char* label)
+int valid_label(char* label, int column)
 {
     int retval = 1;
-    if(directive_name(label) || instructive_name(label)) {
-        printf("In line %d: error: %s is a saved word\n", first_get_line_number(), label);
+    if(directive_of(label, strlen(label)) || instructive_of(label, strlen(label))) {
+        report(first_get_line_number(), column, DIAGNOSTIC_ERROR, "saved-word", "In", "%s is a saved word\n", label);
         retval = ERR;
     }
     else if(symbol_exists(label)) {
-        printf("In line %d: error: %s was already declared\n", first_get_line_number(), label);
+        report(first_get_line_number(), column, DIAGNOSTIC_ERROR, "label-redefined", "In", "%s was already declared\n", label);
         retval = ERR;
     }
     return retval;
@@ -753,29 +739,28 @@ int valid_label(char* label)
  */
 
 /*
- * Reads a comma and proceeds to the next parameter (ignores white spaces).
+ * Reads a comma and proceeds to the next parameter.
  * Prints error messages. returns 1 if valid, 0 otherwise.
  */
-int next_parameter(char line[], int* p)
+int read_comma(char line[], token_line * tokens, int * k)
 {
     int retval = 1;
-    /* checks if there is non space characters in the line, and proceeds to it
-    if the line the line is empty, prints error message*/
-    if(no_more_chars(line, p)){
-        print_err("Missing parameter for this command\n");
+    /* if there are no more tokens in the line, prints error message */
+    if(*k == tokens->count){
+        print_err(token_column(line, tokens, *k), "missing-parameter", "Missing parameter for this command\n");
         retval = ERR;
     }
         /* gets comma, if not prints error message */
-    else if(line[(*p)++] != ','){
-        print_err("Missing comma\n");
+    else if(tokens->tokens[*k].type != TOKEN_COMMA){
+        print_err(token_column(line, tokens, *k) + 1, "missing-comma", "Missing comma\n");
         retval = ERR;
     }
-    else if(no_more_chars(line, p)){ /* same as before */
-        print_err("Missing parameter for command\n");
+    else if(++(*k) == tokens->count){ /* same as before */
+        print_err(token_column(line, tokens, *k), "missing-parameter", "Missing parameter for command\n");
         retval = ERR;
     }
-    else if(line[*p] == ','){
-        print_err("Multiple consecutive commas\n");
+    else if(tokens->tokens[*k].type == TOKEN_COMMA){
+        print_err(token_column(line, tokens, *k), "consecutive-commas", "Multiple consecutive commas\n");
         retval = ERR;
     }
     return retval;	/* Returns 1 if all is well, 0 otherwise */
@@ -783,153 +768,123 @@ int next_parameter(char line[], int* p)
 
 
 /*
- * Reads a number from the line, and checks if it is valid.
- * If it is valid returns 1, otherwise returns 0.
+ * Returns the index in line just after token k - after the closing quote of a string.
  */
-int valid_num(char* line, int* p, double maxNum)
+int token_end(char * line, token * t)
 {
-    int valid;
-    get_num(line, p, &valid, maxNum);
-    return valid;
+    int end = t->start + t->length;
+    if(t->type == TOKEN_STRING && line[end] == '"')
+        end++;
+    return end;
 }
 
-
+/*
+ * Returns the column of token k of the line - the column of the '.' of a directive and of the opening quote of a string -
+ * or the column of the end of the line, if the line has no token k.
+ */
+int token_column(char * line, token_line * tokens, int k)
+{
+    token * t = &tokens->tokens[k];
+    if(k == tokens->count)
+        return strcspn(line, "\n") + 1;
+    return (t->type == TOKEN_DIRECTIVE || t->type == TOKEN_STRING) ? t->start : t->start + 1;
+}
 
 /*
- * Checks if there are more significant characters in line.
- * If there are, proceeds to the next significant character and returns 0, otherwise returns 1.
+ * Returns 1 if token k is followed by another token with no space between them, 0 otherwise.
  */
-int no_more_chars(char* line, int* p)
+int next_to_token(char * line, token_line * tokens, int k)
 {
-    int no_more_chars = 0; /* holds return value */
-    char ch;		/* temporary character */
-    while((ch = line[*p]) == ' ' || ch == '\t') /* moves through line as long as a space/tab is read */
-        (*p)++;
-    if(ch == '\0' || ch == '\n')	/* if end of line reached without significant characters, returns 1 */
-        no_more_chars = 1;
-    return no_more_chars;
+    return k + 1 < tokens->count && token_column(line, tokens, k + 1) == token_end(line, &tokens->tokens[k]) + 1;
 }
 
 /*
- * Reads the register from line.
+ * Reads the register from the tokens.
  * Returns the register number, -1 if not valid.
  * Prints error messages if needed.
  */
-int get_register(char* line, int* p)
-{
-    int retval = -1, j = 0;       /* j - index in la, i index in line*/
-    char ch;
-    char regist[MAX_LINE_LENGTH];   /* holds the number of register read from line (as a string) */
-    if(line[*p] != '$')
-        print_err("parameter is not a register\n");
+int read_register(char* line, token_line * tokens, int * k)
+{
+    int retval = -1;
+    token * t = &tokens->tokens[*k];
+    if(*k == tokens->count || line[t->start] != '$')
+        print_err(token_column(line, tokens, *k), "not-register", "parameter is not a register\n");
+        /* in case got a non digit which is not a space in a middle of a register */
+    else if(t->type != TOKEN_REGISTER)
+        print_err(t->start + 2, "register-characters", "illegal register - contains non digits after $ sign\n");
+    else if(next_to_token(line, tokens, *k) && tokens->tokens[*k + 1].type != TOKEN_COMMA)
+        print_err(token_column(line, tokens, *k + 1), "register-characters", "illegal register - contains non digits after $ sign\n");
+    else if (t->value > MAX_REGISTER_NUM) /* if number is out of range */
+        report(first_get_line_number(), t->start + t->length + 1, DIAGNOSTIC_ERROR, "register-range", "In",
+               "illegal register - %ld is out of range\n", t->value);
     else {
-        (*p)++;
-        while (isdigit(regist[j] = ch = line[(*p)])) {    /* while reads digits, puts them in temp[] */
-            j++;
-            (*p)++;
-        }
-        if(isspace(ch) || ch == '\0' || ch == ',') { /* a proper end of a number */
-            regist[j] = '\0';
-            if (atoi(regist) > MAX_REGISTER_NUM) /* if number is out of range */
-                printf("In line %d: error: illegal register - %d is out of range\n",
-                       first_get_line_number(), atoi(regist));
-            else
-                retval = atoi(regist);
-        }
-        else
-            /* in case got a non digit which is not a space in a middle of a register */
-            print_err("illegal register - contains non digits after $ sign\n");
+        retval = t->value;
+        (*k)++;
     }
     return retval;
 }
 
 /*
- *	get_string is used by asciz to check the validity of the string.
- * 	A valid string is when the first and last character of the string is - ", and all 
- *	characters in between are printable. 
+ *	read_string is used by asciz to check the validity of the string.
+ * 	A valid string is when the first and last character of the string is - ", and all
+ *	characters in between are printable.
  */
-int get_string(char* line, int* p, int* strLength) {
-    int retval = 1, lastQuote; /* lastQoute holds the position in line of the last " */ 
-    lastQuote = get_last_quote(line, *p);
+int read_string(char* line, token_line * tokens, int * k, int* strLength) {
+    int retval = 1, i; /* i - index in line */
+    token * t = &tokens->tokens[*k];
 	/* in case the first and last " are the same (string does not end properly) */
-    if(lastQuote == (*p-1)){	
-        print_err("illegal end of string - should end with \"\n");
+    if(line[t->start + t->length] != '"'){
+        print_err(t->start + 1, "string-end", "illegal end of string - should end with \"\n");
         retval = ERR;
     }
     else {
 	/* goes through the string, and checks all characters are printable */
-        while((*p) < lastQuote && retval){
-            if(!isprint(line[*p])){
-                print_err("illegal char - non printable character in string\n");
+        for(i = t->start; i < t->start + t->length && retval; i++){
+            if(!IS_PRINT(line[i])){
+                print_err(i + 1, "string-character", "illegal char - non printable character in string\n");
                 retval = ERR;
             }
-            else{
-                (*p)++;
+            else
                 (*strLength)++;
-            }
         }
-	(*p)++; /* moves past the last " in line */
+	(*k)++; /* moves past the string */
     }
 	return retval;
 }
 
 
-/*
- *	get_last_quote is used by get_string in order to find the position of the last " in line.
- * 	it returns this position. 
- */ 
-int get_last_quote(char* line, int i){
-	/* goes to the last character in line */
-    while(line[i] != '\n')
-        i++;
-	/* goes back from the end to the first " (from the end) it encounters */
-    while(line[i] != '"')
-        i--;
-    return i;	/* returns the position of the last " */
-}
-
-
 
 /*
  * checks (in case of a significant line) that it is not longer that 80 characters.
  * Returns 1 if the line length is valid, 0 if not (and prints error messages).
  * In any case moves to the next line in the file (for further analysis of  the file).
  */
-int check_line_length(char* line, FILE * file)
+int check_line_length(char* line, file_buffer * source)
 {
 	int retval = 1, i = 0; /* i is the index in line */
-	char ch;	/* assisting character */
 	while(line[i] != '\0')
 		i++;
 	if(line[i-1] != '\n'){ /* if '\n' was not recieved in the first 80 characters in line */
-		print_err("line is longer than 80 characters\n");
+		print_err(i, "line-too-long", "line is longer than 80 characters\n");
 		retval = 0;
-		while((ch = fgetc(file)) != EOF && ch != '\n'); /* moves to next '\n' of EOF */
-		/* if EOF was received, moves one char back in file to avoid segmentation fault.
-		next line analysis will receive EOF and stop analysis */
-		if(ch == EOF)
-			fseek(file, 0, SEEK_END);
+		buffer_skip_line(source); /* moves past the next '\n', or to the end of the file */
 	}
 	return retval;
 }
 
 
 /*
- * Prints errors in a specific format.
+ * Reports an error of the current line, at the given column, with the code naming its kind.
  */
-void print_err(char* error)
+void print_err(int column, char* code, char* error)
 {
-    int lineNumber = first_get_line_number();
-    printf("in line %d: error: %s", lineNumber, error);
+    report(first_get_line_number(), column, DIAGNOSTIC_ERROR, code, "in", "%s", error);
 }
 
 /*
- * Prints warnings in a specific format.
+ * Reports a warning of the current line, at the given column, with the code naming its kind.
  */
-void print_warning(char* error)
+void print_warning(int column, char* code, char* error)
 {
-    int lineNumber = first_get_line_number();
-    printf("in line %d: warning: %s", lineNumber, error);
+    report(first_get_line_number(), column, DIAGNOSTIC_WARNING, code, "in", "%s", error);
 }
-
-
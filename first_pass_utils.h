@@ -2,56 +2,58 @@
 #define FIRST_PASS_UTILS_H
 #include "constants.h"
 #include "label_data_structure.h"
+#include "file_buffer.h"
+#include "global_index.h"
+#include "tokenizer.h"
+#include "char_class.h"
+#include "diagnostics.h"
 #include "first_pass.h"
 #include "constants.h"
 #include <math.h>
 
-enum{ERR, ADD, SUB, AND, OR, NOR, MOVE, MVHI, MVLO, ADDI, SUBI, ANDI, ORI, NORI, BNE, BEQ,
-    BLT, BGT, LB, SB, LW, SW, LH, SH, JMP, LA, CALL, STOP};
-enum{DB = 1, DW, DH, ASCIZ, ENTRY, EXTERN};
-
-int no_more_chars(char* line, int* p);
-int get_string(char* line, int* p, int* strLength);
-int get_last_quote(char* line, int i);
-int check_line_length(char* line, FILE * file);
-
-int get_first_number(char line[], int * p, long numbers[], int* valid, long maxNum);
-int get_numbers(char line[], int * p, long numbers[], int size);
-int next_num(char line[], int* p);
-long get_num(char line[], int* p, int* valid, long maxNum);
-int valid_num(char*, int*, double);
-
-int get_instructive(char * line, int *p);
-int get_directive(char * line, int *p);
-int instructive_name(char* temp);
-int directive_name(char* temp);
-int get_register(char* line, int* p);
-int valid_operand_label(char* label, int isExternal);
-int get_operand_label(char* line, int* p, char* label, int isExternal);
-int next_parameter(char line[], int* p);
-int valid_label(char* label);
-int get_label(char* line, int* p, char* label, int* gotLabel);
-
-int directive_check(char * line, int *p,  char* label, int* gotLabel);
-int process_directive(char* line, int* p, int directive, char* label, int* gotLabel);
-int data_storage_process(char* line, int* p, int directive);
-int asciz_process(char* line, int* p);
-int entry_process(char* line, int* p);
-int extern_process(char* line, int* p);
-
-int I_arithmetic_process(char* line, int* p);
-int I_branched_process(char* line, int* p);
-int I_memory_process(char* line, int* p);
-int La_Call_process(char* line, int* p);
-int Jmp_process(char* line, int* p);
-int R_copy_process(char* line, int* p);
-int R_arithmetic_process(char* line, int* p);
-int instructive_check(char * line, int * p, char* label, int* gotLabel);
-int process_instructive(char* line, int* p, int instructive);
+
+int check_line_length(char* line, file_buffer * source);
+int token_end(char * line, token * t);
+int token_column(char * line, token_line * tokens, int k);
+int next_to_token(char * line, token_line * tokens, int k);
+int read_string(char* line, token_line * tokens, int * k, int* strLength);
+
+int read_numbers(char line[], token_line * tokens, int * k, long numbers[], int size);
+int read_number_comma(char line[], token_line * tokens, int * k);
+long read_number(char line[], token_line * tokens, int * k, int* valid, long maxNum);
+
+int read_instructive(char * line, token_line * tokens, int * k);
+int read_register(char* line, token_line * tokens, int * k);
+int valid_operand_label(char* label, int column, int isExternal);
+int read_operand_label(char* line, token_line * tokens, int * k, char* label, int isExternal);
+int read_comma(char line[], token_line * tokens, int * k);
+int valid_label(char* label, int column);
+int read_label(char* line, token_line * tokens, int * k, char* label, int* gotLabel);
+
+int directive_check(char * line, token_line * tokens, int * k, char* label, int* gotLabel);
+int process_directive(char* line, token_line * tokens, int * k, int directive, char* label, int* gotLabel);
+int address_space_check(int column, long bytes);
+int data_storage_process(char* line, token_line * tokens, int * k, int directive);
+int data_run_process(char* line, token_line * tokens, int * k, int directive);
+int incbin_process(char* line, token_line * tokens, int * k);
+int asciz_process(char* line, token_line * tokens, int * k, int gotLabel, int* dc);
+int entry_process(char* line, token_line * tokens, int * k);
+int extern_process(char* line, token_line * tokens, int * k);
+
+int first_parameter(char* line, token_line * tokens, int * k);
+int I_arithmetic_process(char* line, token_line * tokens, int * k);
+int I_branched_process(char* line, token_line * tokens, int * k);
+int I_memory_process(char* line, token_line * tokens, int * k);
+int La_Call_process(char* line, token_line * tokens, int * k);
+int Jmp_process(char* line, token_line * tokens, int * k);
+int R_copy_process(char* line, token_line * tokens, int * k);
+int R_arithmetic_process(char* line, token_line * tokens, int * k);
+int instructive_check(char * line, token_line * tokens, int * k, char* label, int* gotLabel);
+int process_instructive(char* line, token_line * tokens, int * k, int instructive);
 
 int first_get_line_number();
 
-void print_err(char* error);
-void print_warning(char* error);
+void print_err(int column, char* code, char* error);
+void print_warning(int column, char* code, char* error);
 
 #endif
@@ -0,0 +1,51 @@
+/*
+This file is the fuzzing entry point of the assembler, for libFuzzer (the fuzz target of the makefile, built with clang).
+Every input is assembled as a source file, fully in memory - nothing is read from or written to the disk, and
+the diagnostics are made but never written. The fuzz targets of the makefile define NO_INCBIN, which makes
+.incbin an error (see incbin_process) instead of reading the file it names, so no input can read a file. assemble_source frees every data structure and sets IC and DC back
+after each input, and the diagnostics start over, so a single process assembles input after input from the same state.
+Built with FUZZ_REPLAY defined (the fuzz_replay target), a main is added that runs the inputs in the files given
+as arguments, for reproducing a crash found by the fuzzer without clang.
+*/
+
+#include <stddef.h>
+#include "utils.h"
+#include "output.h"
+#include "diagnostics.h"
+
+int LLVMFuzzerTestOneInput(const unsigned char * data, size_t size)
+{
+    file_buffer source;
+    output_files outputs;
+
+    init_file_buffer(&source);
+    append_to_buffer(&source, (char *) data, (long) size);
+    init_output_files(&outputs);
+    start_diagnostics("fuzz.as");
+    assemble_source(&source, &outputs, NULL);
+    free_output_files(&outputs);
+    free_file_buffer(&source);
+    return 0;
+}
+
+#ifdef FUZZ_REPLAY
+int main(int argc, char *argv[])
+{
+    int i;
+    file_buffer input;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (!load_file_buffer(&input, argv[i]))
+        {
+            printf("Couldn't open file %s\n", argv[i]);
+            continue;
+        }
+        LLVMFuzzerTestOneInput((unsigned char *) input.data, (size_t) input.length);
+        free_file_buffer(&input);
+    }
+    release_data_structures();
+    release_diagnostics();
+    return 0;
+}
+#endif
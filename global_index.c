@@ -0,0 +1,135 @@
+/*
+This file holds the index of global symbols of all the files analyzed in a single run (used with the -g option).
+Every entry and every external label declared by any file is kept in the index (both are added by the first pass,
+so a file that fails later still has all of them in the index), and at the end of the run
+external labels that no file declares as entry, and entries declared by more than one file, are reported.
+This finds unresolved global symbols without linking, and without reading the .ext and .ent files again.
+Every declaration is kept with its line and column, and the errors are reported through diagnostics.c
+as errors of the file that declared the symbol, so they follow --diagnostics like the errors of the passes.
+*/
+
+#include "global_index.h"
+#include "options.h"
+#include "constants.h"
+#include "diagnostics.h"
+
+/* A declaration of a global symbol, and where it is */
+typedef struct global_declaration
+{
+    char * symbol; /* Name of the symbol, kept by one of the tables */
+    int file, line, column;
+} global_declaration;
+
+symbol_hash global_entries; /* Entries of all the files, with the file that declared them first */
+symbol_hash global_externs; /* External labels of all the files, with the file that declared them first */
+char ** global_files = NULL; /* Names of the files, by their index */
+global_declaration * extern_order = NULL; /* External labels, as they were first declared */
+global_declaration * duplicate_entries = NULL; /* Entries declared again by another file, where they were declared again */
+int global_file_count = 0, global_file_capacity = 0;
+long extern_count = 0, extern_capacity = 0, duplicate_count = 0, duplicate_capacity = 0;
+
+void init_global_index()
+{
+    if (!options.global_index)
+        return;
+    init_symbol_hash(&global_entries);
+    init_symbol_hash(&global_externs);
+}
+
+/* Adds a declaration to an array of them, growing it if needed */
+void add_declaration(global_declaration ** declarations, long * count, long * capacity,
+                     char * symbol, int line, int column)
+{
+    if (*count == *capacity)
+    {
+        *capacity = *capacity ? *capacity * 2 : 64;
+        *declarations = (global_declaration *) realloc(*declarations, *capacity * sizeof(global_declaration));
+    }
+    (*declarations)[*count].symbol = symbol;
+    (*declarations)[*count].file = global_file_count - 1;
+    (*declarations)[*count].line = line;
+    (*declarations)[(*count)++].column = column;
+}
+
+/* Sets the file whose symbols are added next */
+void set_global_file(char * file_name)
+{
+    if (!options.global_index)
+        return;
+    if (global_file_count == global_file_capacity)
+    {
+        global_file_capacity = global_file_capacity ? global_file_capacity * 2 : 16;
+        global_files = (char **) realloc(global_files, global_file_capacity * sizeof(char *));
+    }
+    global_files[global_file_count++] = file_name;
+}
+
+void add_global_entry(char * symbol, int line, int column)
+{
+    /* Adds an entry of the current file, declared at line and column, to the index. An entry declared by another file is an error */
+    hash_symbol_ptr previous;
+
+    if (!options.global_index)
+        return;
+    previous = insert_hash_symbol(&global_entries, symbol, 0, global_file_count - 1);
+    if (previous != NULL && previous->owner != global_file_count - 1)
+        add_declaration(&duplicate_entries, &duplicate_count, &duplicate_capacity, previous->symbol, line, column);
+}
+
+void add_global_extern(char * symbol, int line, int column)
+{
+    /* Adds an external label of the current file, declared at line and column, to the index */
+    if (!options.global_index)
+        return;
+    if (insert_hash_symbol(&global_externs, symbol, 0, global_file_count - 1) == NULL)
+        add_declaration(&extern_order, &extern_count, &extern_capacity,
+                        find_hash_symbol(&global_externs, symbol)->symbol, line, column);
+}
+
+/*
+ * Prints the errors found in the index - duplicate entries, and external labels that are not an entry of any file.
+ * Returns 1 if there are no errors, 0 otherwise.
+ */
+int report_global_index()
+{
+    long i;
+    int retval = 1;
+    global_declaration * d;
+
+    if (!options.global_index)
+        return 1;
+    /* every error is reported as an error of the file that declared the symbol, at the declaration */
+    for (i = 0; i < duplicate_count; i++)
+    {
+        d = &duplicate_entries[i];
+        start_diagnostics(global_files[d->file]);
+        report(d->line, d->column, DIAGNOSTIC_ERROR, "duplicate-entry", "In", "entry %s is declared in %s and in %s\n",
+               d->symbol, global_files[find_hash_symbol(&global_entries, d->symbol)->owner], global_files[d->file]);
+        flush_diagnostics();
+        retval = 0;
+    }
+    for (i = 0; i < extern_count; i++)
+    {
+        d = &extern_order[i];
+        if (find_hash_symbol(&global_entries, d->symbol) == NULL)
+        {
+            start_diagnostics(global_files[d->file]);
+            report(d->line, d->column, DIAGNOSTIC_ERROR, "unresolved-extern", "In",
+                   "external label %s declared in %s is not an entry of any file\n", d->symbol, global_files[d->file]);
+            flush_diagnostics();
+            retval = 0;
+        }
+    }
+    return retval;
+}
+
+void free_global_index()
+{
+    if (!options.global_index)
+        return;
+    free_symbol_hash(&global_entries);
+    free_symbol_hash(&global_externs);
+    free(global_files);
+    free(extern_order);
+    free(duplicate_entries);
+}
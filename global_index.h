@@ -0,0 +1,14 @@
+#ifndef GLOBAL_INDEX
+#define GLOBAL_INDEX
+
+#include "symbol_hash.h"
+#include "file_buffer.h"
+
+void init_global_index();
+void set_global_file(char * file_name);
+void add_global_entry(char * symbol, int line, int column);
+void add_global_extern(char * symbol, int line, int column);
+int report_global_index();
+void free_global_index();
+
+#endif
@@ -0,0 +1,137 @@
+/*
+This file holds the pool of label names of the file being analyzed.
+Every distinct name is kept once in the pool and gets an integer id (0, 1, 2, ... in the order of insertion),
+so the symbol table and the externals table keep ids instead of copies of names,
+and two names are equal exactly when their ids are equal.
+Names are found in the pool through an open addressing hash table of ids.
+The pool is emptied between files, and its memory is kept for the next file.
+*/
+
+#include "intern_pool.h"
+#include "symbol_hash.h"
+
+#define INITIAL_POOL_IDS 256 /* Number of ids the pool has room for on its first allocation */
+#define INITIAL_POOL_NAMES 4096 /* Number of characters the pool has room for on its first allocation */
+#define NO_ID -1
+
+char * pool_names = NULL; /* The names, one after another, each terminated by '\0' */
+long pool_names_length = 0, pool_names_capacity = 0;
+long * pool_offsets = NULL; /* Offset in pool_names of the name of every id */
+int * pool_slots = NULL; /* The hash table - ids, or NO_ID for an empty slot */
+int pool_count = 0, pool_ids_capacity = 0;
+long pool_slot_count = 0; /* Number of slots in the hash table - a power of 2, at least twice the ids capacity */
+
+void init_intern_pool()
+{
+    long i;
+
+    if (pool_offsets != NULL)
+        return;
+    pool_ids_capacity = INITIAL_POOL_IDS;
+    pool_offsets = (long *) malloc(pool_ids_capacity * sizeof(long));
+    pool_slot_count = 2 * pool_ids_capacity;
+    pool_slots = (int *) malloc(pool_slot_count * sizeof(int));
+    for (i = 0; i < pool_slot_count; i++)
+        pool_slots[i] = NO_ID;
+    pool_names_capacity = INITIAL_POOL_NAMES;
+    pool_names = (char *) malloc(pool_names_capacity);
+}
+
+/* Returns the slot of a name in the hash table - the slot of its id, or the empty slot it belongs to */
+long find_pool_slot(char * symbol)
+{
+    long slot = hash_string(symbol) & (pool_slot_count - 1);
+
+    while (pool_slots[slot] != NO_ID && strcmp(pool_names + pool_offsets[pool_slots[slot]], symbol))
+        slot = (slot + 1) & (pool_slot_count - 1);
+    return slot;
+}
+
+/* Doubles the room for ids, and rebuilds the hash table to keep it at most half full */
+void grow_intern_pool()
+{
+    int id;
+    long i;
+
+    pool_ids_capacity *= 2;
+    pool_offsets = (long *) realloc(pool_offsets, pool_ids_capacity * sizeof(long));
+    pool_slot_count = 2 * pool_ids_capacity;
+    pool_slots = (int *) realloc(pool_slots, pool_slot_count * sizeof(int));
+    for (i = 0; i < pool_slot_count; i++)
+        pool_slots[i] = NO_ID;
+    for (id = 0; id < pool_count; id++)
+        pool_slots[find_pool_slot(pool_names + pool_offsets[id])] = id;
+}
+
+/* Returns the id of a name, adding it to the pool if it isn't there */
+int intern_symbol(char * symbol)
+{
+    long slot, length;
+
+    init_intern_pool();
+    slot = find_pool_slot(symbol);
+    if (pool_slots[slot] != NO_ID)
+        return pool_slots[slot];
+
+    if (pool_count == pool_ids_capacity)
+    {
+        grow_intern_pool();
+        slot = find_pool_slot(symbol);
+    }
+    length = strlen(symbol) + 1;
+    while (pool_names_length + length > pool_names_capacity)
+    {
+        pool_names_capacity *= 2;
+        pool_names = (char *) realloc(pool_names, pool_names_capacity);
+    }
+    memcpy(pool_names + pool_names_length, symbol, length);
+    pool_offsets[pool_count] = pool_names_length;
+    pool_names_length += length;
+    pool_slots[slot] = pool_count;
+    return pool_count++;
+}
+
+/* Returns the id of a name, or -1 if it isn't in the pool */
+int find_interned_symbol(char * symbol)
+{
+    if (pool_count == 0)
+        return NO_ID;
+    return pool_slots[find_pool_slot(symbol)];
+}
+
+/* Returns the name of an id. The name is valid until the next name is added to the pool */
+char * interned_name(int id)
+{
+    return pool_names + pool_offsets[id];
+}
+
+int interned_count()
+{
+    return pool_count;
+}
+
+void reset_intern_pool()
+{
+    /* Empties the pool for the next file, keeping its memory */
+    long i;
+
+    for (i = 0; i < pool_slot_count; i++)
+        pool_slots[i] = NO_ID;
+    pool_count = 0;
+    pool_names_length = 0;
+}
+
+void release_intern_pool()
+{
+    free(pool_names);
+    free(pool_offsets);
+    free(pool_slots);
+    pool_names = NULL;
+    pool_offsets = NULL;
+    pool_slots = NULL;
+    pool_count = 0;
+    pool_ids_capacity = 0;
+    pool_slot_count = 0;
+    pool_names_length = 0;
+    pool_names_capacity = 0;
+}
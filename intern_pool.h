@@ -0,0 +1,16 @@
+#ifndef INTERN_POOL
+#define INTERN_POOL
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+void init_intern_pool();
+int intern_symbol(char * symbol);
+int find_interned_symbol(char * symbol);
+char * interned_name(int id);
+int interned_count();
+void reset_intern_pool();
+void release_intern_pool();
+
+#endif
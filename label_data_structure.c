@@ -1,63 +1,158 @@
 /*
 This file holds functions to deal with the data structure that holds the labels as a linked list.
 The data structure holds the labels and their adresses in memory, and is filled in the first pass.
+Every row keeps the id of its label in the intern pool instead of the name itself, and the first row of every id
+is kept in symbol_rows, so a label is found by its id without going through the list.
+A label is kept as its section and its offset in it, and its address is found only when it is needed, from the
+addresses the sections start at (see set_section_bases) - so the values of data labels never have to be
+updated once the size of the code is known.
+The rows of the labels declared as entries are also kept in an index of their own, so the entries are found
+without going through the whole table.
 */
 
 #include "label_data_structure.h"
 #include "constants.h"
+#include "intern_pool.h"
+
+row_ptr symbol_head, symbol_tail;
+row_ptr free_symbol_rows = NULL; /* Rows freed by previous files, kept to be reused */
+row_ptr * symbol_rows = NULL; /* The first row of every id of the intern pool, NULL for ids without a row */
+int symbol_rows_capacity = 0;
+int symbol_count = 0; /* Number of rows inserted to the table */
+row_ptr * entry_rows = NULL; /* Rows of the entries, in the order they were declared as entries until sorted */
+int entry_count = 0, entry_capacity = 0;
+int entries_sorted = 1; /* 1 if entry_rows is in the order of the table */
+int section_bases[2] = {INITIAL_ADDRESS, INITIAL_ADDRESS}; /* Addresses of the code and of the data, by section */
+
+/*
+ * Returns an empty row with room for attributes of maximal length.
+ * Rows freed by a previous file are reused before allocating new ones.
+ */
+row_ptr new_symbol_row()
+{
+    row_ptr row;
+
+    if (free_symbol_rows != NULL)
+    {
+        row = free_symbol_rows;
+        free_symbol_rows = free_symbol_rows->next;
+    }
+    else
+    {
+        row = (row_ptr)malloc(sizeof(symbol_table_row));
+        row->attributes = (char *) malloc(MAX_ATTRIBUTE_LENGTH);
+    }
+    row->next = NULL;
+    return row;
+}
 
 void init_symbol_table()
 {
-    symbol_head = (row_ptr)malloc(sizeof(symbol_table_row));
+    symbol_head = new_symbol_row();
     symbol_tail = symbol_head;
-    symbol_tail->next = NULL;
+    symbol_count = 0;
+    entry_count = 0;
+    entries_sorted = 1;
+    if (symbol_rows != NULL)
+        memset(symbol_rows, 0, symbol_rows_capacity * sizeof(row_ptr));
 }
 
-void add_to_data(int ICF){
-    row_ptr temp;
-    get_symbol_head(&temp);
-    while(temp != NULL)
+row_ptr find_symbol_row(char * symbol)
+{
+    /* Returns the first row of a symbol, NULL if it doesn't exist */
+    int id = find_interned_symbol(symbol);
+
+    if (id < 0 || id >= symbol_rows_capacity)
+        return NULL;
+    return symbol_rows[id];
+}
+
+void set_section_bases(int code_base, int data_base)
+{
+    /* Sets the addresses the code and the data start at - the data starts at ICF, right after the code */
+    section_bases[CODE_SECTION] = code_base;
+    section_bases[DATA_SECTION] = data_base;
+}
+
+int symbol_address(row_ptr row)
+{
+    /* Returns the address of a label, 0 for an external label */
+    if (row->section == NO_SECTION)
+        return 0;
+    return section_bases[row->section] + row->offset;
+}
+
+void add_entry_row(row_ptr row)
+{
+    /* Adds a row to the index of entries (once - only when its attributes become an entry) */
+    if (entry_count == entry_capacity)
     {
-        if (!strcmp("data", temp->attributes))
-            temp->value += ICF;
-        temp = temp->next;
+        entry_capacity = entry_capacity == 0 ? 16 : 2 * entry_capacity;
+        entry_rows = (row_ptr *) realloc(entry_rows, entry_capacity * sizeof(row_ptr));
     }
+    if (entry_count > 0 && entry_rows[entry_count - 1]->order > row->order)
+        entries_sorted = 0;
+    entry_rows[entry_count++] = row;
+}
+
+int compare_entry_rows(const void * first, const void * second)
+{
+    return (*(row_ptr *) first)->order - (*(row_ptr *) second)->order;
+}
+
+int get_entry_rows(row_ptr ** rows)
+{
+    /* Points rows at the rows of the entries, in the order of the symbol table, and returns their number */
+    if (!entries_sorted)
+    {
+        qsort(entry_rows, entry_count, sizeof(row_ptr), compare_entry_rows);
+        entries_sorted = 1;
+    }
+    (*rows) = entry_rows;
+    return entry_count;
 }
 
 int add_entry_to(char * symbol)
 {
-    row_ptr temp_row;
-    get_symbol_head(&temp_row);
-    while (temp_row != NULL)
+    row_ptr temp_row = find_symbol_row(symbol);
+    if (temp_row != NULL)
     {
-        if (!strcmp(temp_row->symbol, symbol)){
-            if(!strcmp(temp_row->attributes, "code")){
-                strcpy(temp_row->attributes, "code,entry");
-            }
-            else if(!strcmp(temp_row->attributes, "data"))
-                strcpy(temp_row->attributes, "data,entry");
-            return 1;
+        if(!strcmp(temp_row->attributes, "code")){
+            strcpy(temp_row->attributes, "code,entry");
+            add_entry_row(temp_row);
+        }
+        else if(!strcmp(temp_row->attributes, "data")) {
+            strcpy(temp_row->attributes, "data,entry");
+            add_entry_row(temp_row);
         }
-        temp_row = temp_row->next;
+        return 1;
     }
     return 0;
 }
 
-void insert_symbol(char * symbol, int value, char * attributes)
+void insert_symbol(char * symbol, int section, int offset, char * attributes)
 {
-    /* Inserts a new symbol to the symbol table, with given symbol, address, and attributes */
+    /* Inserts a new symbol to the symbol table, with given symbol, section, offset in the section, and attributes */
 
-    row_ptr new_row = (row_ptr)malloc(sizeof(symbol_table_row)); /* Initialize new row*/
+    row_ptr new_row = new_symbol_row(); /* Initialize new row*/
     row_ptr last_row;
-    int len_symbol;
-    len_symbol = strlen(symbol);
+    int capacity = symbol_rows_capacity;
     get_symbol_tail(&last_row);
 
-    new_row->symbol = (char *) malloc(len_symbol+1);
-    strcpy(new_row->symbol, symbol);
+    new_row->id = intern_symbol(symbol);
+    if (new_row->id >= symbol_rows_capacity)
+    {
+        /* makes room for the new id, and for the ids that will follow it */
+        symbol_rows_capacity = 2 * (new_row->id + 1);
+        symbol_rows = (row_ptr *) realloc(symbol_rows, symbol_rows_capacity * sizeof(row_ptr));
+        memset(symbol_rows + capacity, 0, (symbol_rows_capacity - capacity) * sizeof(row_ptr));
+    }
+    if (symbol_rows[new_row->id] == NULL)
+        symbol_rows[new_row->id] = new_row;
 
-    new_row->value = value;
-    new_row->attributes = (char *) malloc(MAX_ATTRIBUTE_LENGTH);
+    new_row->section = section;
+    new_row->offset = offset;
+    new_row->order = symbol_count++;
     strcpy(new_row->attributes, attributes);
 
     new_row->next = NULL;
@@ -69,28 +164,19 @@ void insert_symbol(char * symbol, int value, char * attributes)
 int get_symbol_value(char * symbol)
 {
     /* Returns the address of a label with a given symbol, -1 if doesn't exist */
-    row_ptr temp_row;
-    get_symbol_head(&temp_row);
-    while (temp_row != NULL)
-    {
-        if (!strcmp(temp_row->symbol, symbol))
-            return temp_row->value;
-        temp_row = temp_row->next;
-    }
+    row_ptr temp_row = find_symbol_row(symbol);
+    if (temp_row != NULL)
+        return symbol_address(temp_row);
     return -1;
 }
 
 int get_symbol_attributes(char * symbol, char * attributes)
 {
     /* Copies the attributes for a given symbol, into the given string*/
-    row_ptr temp_row;
-    get_symbol_head(&temp_row);
-    while (temp_row != NULL) {
-        if (!strcmp(temp_row->symbol, symbol)) {
-            strcpy(attributes, temp_row->attributes);
-            return 1;
-        }
-        temp_row = temp_row->next;
+    row_ptr temp_row = find_symbol_row(symbol);
+    if (temp_row != NULL) {
+        strcpy(attributes, temp_row->attributes);
+        return 1;
     }
     return 0;
 }
@@ -98,16 +184,7 @@ int get_symbol_attributes(char * symbol, char * attributes)
 int symbol_exists(char * symbol)
 {
     /* Checks if a symbol exists in the symbol table */
-    row_ptr first_row, temp_row;
-    get_symbol_head(&first_row);
-    temp_row = first_row;
-    while (temp_row != NULL)
-    {
-        if (!strcmp(temp_row->symbol, symbol))
-            return 1;
-        temp_row = temp_row->next;
-    }
-    return 0;
+    return find_symbol_row(symbol) != NULL;
 }
 
 void get_symbol_head_to_free(row_ptr* ptrhead)
@@ -134,17 +211,34 @@ void progress_symbol_tail()
 
 void free_symbol_table(row_ptr * head)
 {
+    /* Moves the whole table (including the dummy row) to the free rows, for the next file */
     row_ptr tmp;
-	tmp = (*head);
-    (*head) = (*head)->next;
-    free(tmp);
-	
+
     while ((*head) != NULL)
     {
         tmp = (*head);
         (*head) = (*head)->next;
-        free(tmp->symbol);
+        tmp->next = free_symbol_rows;
+        free_symbol_rows = tmp;
+    }
+}
+
+void release_symbol_rows()
+{
+    /* Frees the rows kept for reuse, once there are no more files to analyze */
+    row_ptr tmp;
+
+    while (free_symbol_rows != NULL)
+    {
+        tmp = free_symbol_rows;
+        free_symbol_rows = free_symbol_rows->next;
         free(tmp->attributes);
         free(tmp);
     }
+    free(symbol_rows);
+    symbol_rows = NULL;
+    symbol_rows_capacity = 0;
+    free(entry_rows);
+    entry_rows = NULL;
+    entry_capacity = 0;
 }
@@ -4,29 +4,39 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include "relocation_data_structure.h"
+
+#define NO_SECTION -1 /* Section of external labels, whose address is only known when linking */
 
 typedef struct row * row_ptr;
 typedef struct row
 {
-    char * symbol;
-    int value;
+    int id; /* Id of the label in the intern pool */
+    int section; /* CODE_SECTION, DATA_SECTION, or NO_SECTION for external labels */
+    int offset; /* Offset of the label from the start of its section (see symbol_address) */
+    int order; /* Number of rows inserted before this row, for keeping entries in the order of the table */
     char * attributes;
     row_ptr next;
 } symbol_table_row;
 
-row_ptr symbol_head, symbol_tail;
+extern row_ptr symbol_head, symbol_tail;
 
 int add_entry_to(char * symbol);
-void add_to_data(int ICF);
+int get_entry_rows(row_ptr ** rows);
+void set_section_bases(int code_base, int data_base);
+int symbol_address(row_ptr row);
 void get_symbol_head(row_ptr* ptrhead);
 void get_symbol_tail(row_ptr* ptrtail);
-void insert_symbol(char * symbol, int value, char * attributes);
+void insert_symbol(char * symbol, int section, int offset, char * attributes);
 void progress_symbol_tail();
 int get_symbol_value(char * symbol);
 int get_symbol_attributes(char * symbol, char * attributes);
 int symbol_exists(char * symbol);
+row_ptr find_symbol_row(char * symbol);
 void free_symbol_table(row_ptr * head);
 void init_symbol_table();
 void get_symbol_head_to_free(row_ptr* ptrhead);
+row_ptr new_symbol_row();
+void release_symbol_rows();
 
 #endif
@@ -0,0 +1,507 @@
+/*
+This file is the linker - it links modules made by the assembler into one final image.
+Usage: linker [-b base_address] output_name module...
+A module is given by the name of its source file (as it was given to the assembler). Its .ob, .ext, .ent and .rel
+files are read, so modules must be assembled with the -r option. A module whose name ends with .obj is read
+as a binary object file instead (assembled with -f bin).
+The code of all the modules is placed one after another from the base address, followed by the data of all
+the modules. Every word listed in a module's relocations is moved along with the section it points into,
+every external label used is patched with the address of the entry of the same name from any module,
+and the final image is written to output_name.ob, in the same format the assembler writes.
+Duplicate entries and external labels that no module declares as entry are reported, and then no image is written.
+The base address is a multiple of 4 up to MAX_BASE_ADDRESS, as for the assembler, and the final image must end
+by MAX_ADDRESS, the highest address a J instructive holds - so every relocated address fits its field as it is.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "constants.h"
+#include "file_buffer.h"
+#include "object_reader.h"
+#include "symbol_hash.h"
+
+#define MASK_ADDRESS 0x1FFFFFFUL /* Mask of the 25 bit address field of a J instructive */
+
+typedef struct module_row
+{
+    char * name; /* Name of a label (NULL for relocations) */
+    long address; /* Value of an entry, address of an external use, or address of a relocated word */
+    int section; /* Section a relocated word points into - 0 for code, 1 for data */
+} module_row;
+
+typedef struct module
+{
+    char * name; /* Name of the module, as given in the arguments */
+    file_buffer files[4]; /* Files read for the module (.ob, .ext, .ent, .rel, or only the .obj file) */
+    unsigned char * code; /* Code image of the module */
+    unsigned char * data; /* Data image of the module */
+    unsigned char * text_image; /* Image read from a .ob file (code and data), NULL for .obj modules */
+    long code_size, data_size; /* ICF and DCF of the module */
+    long base; /* Address the module was assembled at */
+    long code_base, data_base; /* Addresses of the code and data of the module in the final image */
+    module_row * entries, * externs, * relocations; /* Tables of the module */
+    long entry_count, extern_count, relocation_count;
+} module;
+
+/* Returns a newly allocated copy of name with the given extension appended */
+char * module_file_name(char * name, char * extension)
+{
+    char * file_name = (char *) malloc(strlen(name) + strlen(extension) + 1);
+
+    strcpy(file_name, name);
+    strcat(file_name, extension);
+    return file_name;
+}
+
+/* Reads a file of a module. A missing optional file is read as empty. Returns 1 on success, 0 otherwise */
+int load_module_file(module * mod, file_buffer * buffer, char * extension, int optional)
+{
+    char * file_name = module_file_name(mod->name, extension);
+    int retval = 1;
+
+    if (!load_file_buffer(buffer, file_name))
+    {
+        init_file_buffer(buffer);
+        if (!optional)
+        {
+            printf("error: couldn't read %s\n", file_name);
+            retval = 0;
+        }
+    }
+    free(file_name);
+    return retval;
+}
+
+/*
+ * Splits the next line of a text file (.ext, .ent or .rel) into its two words, in place.
+ * Returns 1 if a line was read, 0 at the end of the file.
+ */
+int next_text_row(file_buffer * buffer, char ** first, char ** second)
+{
+    char * data = buffer->data;
+
+    while (buffer->position < buffer->length && (data[buffer->position] == '\n' || data[buffer->position] == ' '))
+        buffer->position++;
+    if (buffer->position >= buffer->length)
+        return 0;
+
+    *first = data + buffer->position;
+    while (buffer->position < buffer->length && data[buffer->position] != ' ' && data[buffer->position] != '\n')
+        buffer->position++;
+    if (buffer->position < buffer->length && data[buffer->position] == ' ')
+        data[buffer->position++] = '\0';
+
+    *second = data + buffer->position;
+    while (buffer->position < buffer->length && data[buffer->position] != '\n')
+        buffer->position++;
+    if (buffer->position < buffer->length)
+        data[buffer->position++] = '\0';
+    return 1;
+}
+
+/* Reads the rows of a .ext, .ent or .rel file into a table. Returns the number of rows */
+long read_text_table(file_buffer * buffer, module_row ** table, int relocations)
+{
+    long count = 0, capacity = 16;
+    char * first, * second;
+
+    append_to_buffer(buffer, "\n", 1); /* terminates the last line */
+    (*table) = (module_row *) malloc(capacity * sizeof(module_row));
+    while (next_text_row(buffer, &first, &second))
+    {
+        if (count == capacity)
+        {
+            capacity *= 2;
+            (*table) = (module_row *) realloc((*table), capacity * sizeof(module_row));
+        }
+        if (relocations)
+        {
+            (*table)[count].name = NULL;
+            (*table)[count].address = strtol(first, NULL, 10);
+            (*table)[count].section = !strcmp(second, "data");
+        }
+        else
+        {
+            (*table)[count].name = first;
+            (*table)[count].address = strtol(second, NULL, 10);
+            (*table)[count].section = 0;
+        }
+        count++;
+    }
+    return count;
+}
+
+/* Reads the image of a .ob file. Returns 1 if valid, 0 otherwise, TEXT_OBJECT_NO_MEMORY if there is no memory for it */
+int read_text_image(module * mod, file_buffer * ob)
+{
+    object_image image;
+    int valid = read_text_object(&image, ob);
+
+    mod->text_image = image.bytes;
+    mod->code = image.code;
+    mod->data = image.data;
+    mod->code_size = image.code_size;
+    mod->data_size = image.data_size;
+    mod->base = image.base;
+    return valid;
+}
+
+/* Reads the tables of a binary object file. Returns 1 if valid, 0 otherwise */
+int read_object_module(module * mod)
+{
+    object_image image;
+    unsigned long i, value, section;
+
+    if (!open_object_image(&image, (unsigned char *) mod->files[0].data, mod->files[0].length))
+        return 0;
+    mod->code = image.code;
+    mod->data = image.data;
+    mod->code_size = image.code_size;
+    mod->data_size = image.data_size;
+    mod->base = image.base;
+
+    mod->entry_count = image.entry_count;
+    mod->entries = (module_row *) malloc((image.entry_count + 1) * sizeof(module_row));
+    for (i = 0; i < image.entry_count; i++)
+    {
+        mod->entries[i].name = object_entry(&image, i, &value);
+        mod->entries[i].address = value;
+    }
+    mod->extern_count = image.extern_count;
+    mod->externs = (module_row *) malloc((image.extern_count + 1) * sizeof(module_row));
+    for (i = 0; i < image.extern_count; i++)
+    {
+        mod->externs[i].name = object_extern(&image, i, &value);
+        mod->externs[i].address = value;
+    }
+    mod->relocation_count = image.relocation_count;
+    mod->relocations = (module_row *) malloc((image.relocation_count + 1) * sizeof(module_row));
+    for (i = 0; i < image.relocation_count; i++)
+    {
+        mod->relocations[i].name = NULL;
+        mod->relocations[i].address = object_relocation(&image, i, &section);
+        mod->relocations[i].section = section;
+    }
+    for (i = 0; i < image.entry_count; i++)
+        if (mod->entries[i].name == NULL)
+            return 0;
+    for (i = 0; i < image.extern_count; i++)
+        if (mod->externs[i].name == NULL)
+            return 0;
+    return 1;
+}
+
+/* Reads all the files of a module. Returns 1 if valid, 0 otherwise (and prints an error message) */
+int load_module(module * mod, char * name)
+{
+    int i, valid, length = strlen(name);
+
+    memset(mod, 0, sizeof(module));
+    mod->name = name;
+    for (i = 0; i < 4; i++)
+        init_file_buffer(&mod->files[i]);
+
+    if (length > 4 && !strcmp(name + length - 4, ".obj"))
+    {
+        if (!load_module_file(mod, &mod->files[0], "", 0))
+            return 0;
+        if (!read_object_module(mod))
+        {
+            printf("error: %s is not a valid object file\n", name);
+            return 0;
+        }
+        return 1;
+    }
+
+    if (!load_module_file(mod, &mod->files[0], ".ob", 0) || !load_module_file(mod, &mod->files[1], ".ext", 1) ||
+        !load_module_file(mod, &mod->files[2], ".ent", 1))
+        return 0;
+    if (!load_module_file(mod, &mod->files[3], ".rel", 0))
+    {
+        printf("error: module %s must be assembled with the -r option\n", name);
+        return 0;
+    }
+    mod->extern_count = read_text_table(&mod->files[1], &mod->externs, 0);
+    mod->entry_count = read_text_table(&mod->files[2], &mod->entries, 0);
+    mod->relocation_count = read_text_table(&mod->files[3], &mod->relocations, 1);
+    if ((valid = read_text_image(mod, &mod->files[0])) == TEXT_OBJECT_NO_MEMORY)
+        printf("error: out of memory for the image of %s.ob\n", name);
+    else if (!valid)
+        printf("error: %s.ob is not a valid object file\n", name);
+    return valid == 1;
+}
+
+void free_module(module * mod)
+{
+    int i;
+
+    for (i = 0; i < 4; i++)
+        free_file_buffer(&mod->files[i]);
+    free(mod->text_image);
+    free(mod->entries);
+    free(mod->externs);
+    free(mod->relocations);
+}
+
+/* Returns the address in the final image of an address of the module (in its code or its data) */
+long relocate_address(module * mod, long address, int section)
+{
+    if (section == 0)
+        return address - mod->base + mod->code_base;
+    return address - mod->base - mod->code_size + mod->data_base;
+}
+
+/*
+ * Sets the address field of the J word at the given offset of the image.
+ * Returns 1 on success, 0 if the address doesn't fit the field (and prints an error message).
+ */
+int patch_address(module * mod, unsigned char * image, long offset, long address)
+{
+    unsigned long word = read_object_word(image + offset);
+    int i;
+
+    if (address < 0 || address > MAX_ADDRESS)
+    {
+        printf("error: address %ld used in module %s doesn't fit in the address field\n", address, mod->name);
+        return 0;
+    }
+    word = (word & ~MASK_ADDRESS & 0xFFFFFFFFUL) | ((unsigned long) address & MASK_ADDRESS);
+    for (i = 0; i < 4; i++)
+    {
+        image[offset + i] = (unsigned char) (word & MASK_8_BITS);
+        word >>= 8;
+    }
+    return 1;
+}
+
+/*
+ * Checks that the address in a relocated word is inside the section of the module it points into.
+ * Returns 1 if valid, 0 otherwise (and prints an error message).
+ */
+int valid_relocation(module * mod, long address, int section)
+{
+    long start = mod->base + (section == 0 ? 0 : mod->code_size);
+    long size = section == 0 ? mod->code_size : mod->data_size;
+
+    if (address < start || address > start + size)
+    {
+        printf("error: relocated address %ld in module %s is outside of its %s\n", address, mod->name,
+               section == 0 ? "code" : "data");
+        return 0;
+    }
+    return 1;
+}
+
+/*
+ * Checks that an address of a word used by a module (relocation or external) is inside its code.
+ * Returns the offset of the word from the start of the module's code, or -1 if not valid.
+ */
+long code_word_offset(module * mod, long address)
+{
+    long offset = address - mod->base;
+
+    if (offset < 0 || offset % 4 != 0 || offset + 4 > mod->code_size)
+    {
+        printf("error: address %ld in module %s is not a code word\n", address, mod->name);
+        return -1;
+    }
+    return offset;
+}
+
+/* Inserts the entries of all the modules to the table. Returns 1 if there are no duplicates, 0 otherwise */
+int collect_entries(module * modules, int count, symbol_hash * entries)
+{
+    int i, retval = 1;
+    long j;
+    module_row * row;
+    hash_symbol_ptr previous;
+
+    for (i = 0; i < count; i++)
+    {
+        for (j = 0; j < modules[i].entry_count; j++)
+        {
+            row = &modules[i].entries[j];
+            row->section = row->address >= modules[i].base + modules[i].code_size;
+            previous = insert_hash_symbol(entries, row->name,
+                                          relocate_address(&modules[i], row->address, row->section), i);
+            if (previous != NULL)
+            {
+                printf("error: entry %s is declared in module %s and in module %s\n",
+                       row->name, modules[previous->owner].name, modules[i].name);
+                retval = 0;
+            }
+        }
+    }
+    return retval;
+}
+
+/*
+ * Copies the code and data of every module to the final image, and fixes the relocated words and the
+ * uses of external labels. Returns 1 if valid, 0 otherwise.
+ */
+int link_image(module * modules, int count, symbol_hash * entries, unsigned char * image, long base)
+{
+    int i, retval = 1;
+    long j, offset, word_offset, address;
+    module * mod;
+    module_row * row;
+    hash_symbol_ptr entry;
+
+    for (i = 0; i < count; i++)
+    {
+        mod = &modules[i];
+        offset = mod->code_base - base;
+        memcpy(image + offset, mod->code, mod->code_size);
+        memcpy(image + mod->data_base - base, mod->data, mod->data_size);
+
+        for (j = 0; j < mod->relocation_count; j++)
+        {
+            row = &mod->relocations[j];
+            if ((word_offset = code_word_offset(mod, row->address)) < 0)
+            {
+                retval = 0;
+                continue;
+            }
+            address = read_object_word(image + offset + word_offset) & MASK_ADDRESS;
+            if (!valid_relocation(mod, address, row->section) ||
+                !patch_address(mod, image, offset + word_offset, relocate_address(mod, address, row->section)))
+                retval = 0;
+        }
+        for (j = 0; j < mod->extern_count; j++)
+        {
+            row = &mod->externs[j];
+            if ((entry = find_hash_symbol(entries, row->name)) == NULL)
+            {
+                printf("error: external label %s used in module %s is not an entry of any module\n",
+                       row->name, mod->name);
+                retval = 0;
+            }
+            else if ((word_offset = code_word_offset(mod, row->address)) < 0 ||
+                     !patch_address(mod, image, offset + word_offset, entry->value))
+                retval = 0;
+        }
+    }
+    return retval;
+}
+
+/* Writes the final image to a .ob file, in the format of the assembler */
+int write_image(char * name, unsigned char * image, long base, long code_size, long data_size)
+{
+    long i, address = base;
+    char text[MAX_LINE_LENGTH];
+    char * file_name = module_file_name(name, ".ob");
+    file_buffer output;
+    int retval;
+
+    init_file_buffer(&output);
+    sprintf(text, "     %ld %ld     ", code_size, data_size);
+    append_string_to_buffer(&output, text);
+    for (i = 0; i < code_size; i++, address++)
+    {
+        if (i % 4 == 0)
+        {
+            sprintf(text, "\n0%ld ", address);
+            append_string_to_buffer(&output, text);
+        }
+        sprintf(text, "%02X ", image[i]);
+        append_string_to_buffer(&output, text);
+    }
+    if (address % 4 == 0)
+    {
+        sprintf(text, "\n0%ld ", address);
+        append_string_to_buffer(&output, text);
+    }
+    for (; i < code_size + data_size; i++)
+    {
+        sprintf(text, "%02X ", image[i]);
+        append_string_to_buffer(&output, text);
+        if (++address % 4 == 0)
+        {
+            sprintf(text, "\n0%ld ", address);
+            append_string_to_buffer(&output, text);
+        }
+    }
+
+    retval = write_file_buffer(&output, file_name);
+    if (!retval)
+        printf("error: couldn't write %s\n", file_name);
+    free_file_buffer(&output);
+    free(file_name);
+    return retval;
+}
+
+int main(int argc, char *argv[])
+{
+    int i, first = 1, count, retval = 1, fits = 1;
+    long base = INITIAL_ADDRESS, code_size = 0, data_size = 0;
+    module * modules;
+    symbol_hash entries;
+    unsigned char * image;
+    char * end;
+
+    if (argc > 2 && !strcmp(argv[1], "-b"))
+    {
+        base = strtol(argv[2], &end, 10);
+        if (*end != '\0' || end == argv[2] || base < 0 || base % 4 != 0 || base > MAX_BASE_ADDRESS)
+        {
+            printf("Illegal base address %s - must be a multiple of 4 between 0 and %d\n", argv[2], MAX_BASE_ADDRESS);
+            return 1;
+        }
+        first = 3;
+    }
+    if (argc - first < 2)
+    {
+        printf("Usage: linker [-b base_address] output_name module...\n");
+        return 1;
+    }
+
+    count = argc - first - 1;
+    modules = (module *) malloc(count * sizeof(module));
+    for (i = 0; i < count; i++)
+        if (!load_module(&modules[i], argv[first + 1 + i]))
+            retval = 0;
+
+    /* code of all the modules first, then data of all the modules - checked to fit as it grows, so it never overflows */
+    for (i = 0; retval && fits && i < count; i++)
+    {
+        fits = modules[i].code_size >= 0 && modules[i].code_size <= MAX_ADDRESS + 1L - base - code_size;
+        modules[i].code_base = base + code_size;
+        code_size += modules[i].code_size;
+    }
+    for (i = 0; retval && fits && i < count; i++)
+    {
+        fits = modules[i].data_size >= 0 && modules[i].data_size <= MAX_ADDRESS + 1L - base - code_size - data_size;
+        modules[i].data_base = base + code_size + data_size;
+        data_size += modules[i].data_size;
+    }
+    if (!fits)
+    {
+        printf("error: the code and data of the modules don't fit between address %ld and address %d\n",
+               base, MAX_ADDRESS);
+        retval = 0;
+    }
+    if (retval && (image = (unsigned char *) malloc(code_size + data_size + 1)) == NULL)
+    {
+        printf("error: not enough memory for an image of %ld bytes\n", code_size + data_size);
+        retval = 0;
+    }
+
+    if (retval)
+    {
+        init_symbol_hash(&entries);
+        if (!collect_entries(modules, count, &entries))
+            retval = 0;
+        if (!link_image(modules, count, &entries, image, base))
+            retval = 0;
+        if (retval)
+            retval = write_image(argv[first], image, base, code_size, data_size);
+        free(image);
+        free_symbol_hash(&entries);
+    }
+
+    for (i = 0; i < count; i++)
+        free_module(&modules[i]);
+    free(modules);
+    return retval ? 0 : 1;
+}
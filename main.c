@@ -1,52 +1,165 @@
 #include "first_pass.h"
 #include "external_data_structure.h"
 #include "binary_data_structure.h"
+#include "file_buffer.h"
 #include "output.h"
+#include "output_cache.h"
+#include "options.h"
+#include "global_index.h"
+#include "diagnostics.h"
+#include "watch.h"
 #include "utils.h"
+#include "timings.h"
+#include "serve.h"
 
-int DC = 0;
-int IC = INITIAL_ADDRESS;
+/*
+ * Checks a single file for errors without making its code and data tables or its output files (--check).
+ * Only the symbol table is made, for checking the labels used as operands.
+ * Frees the source. Returns 1.
+ */
+int check_file(file_buffer * source)
+{
+    int valid;
 
-int main(int argc, char *argv[])
+    init_data_structures();
+    start_stage();
+    valid = first_pass(source);
+    end_stage(STAGE_FIRST_PASS);
+    if (valid)
+    {
+        rewind_file_buffer(source);
+        start_stage();
+        check_pass(source);
+        end_stage(STAGE_SECOND_PASS);
+    }
+    flush_diagnostics();
+    free_data_structures();
+    free_file_buffer(source);
+    IC = options.base_address;
+    DC = 0;
+    return 1;
+}
+
+/*
+ * Analyzes a single file, and makes its output files if it is valid.
+ * next_file_name is the file that will be analyzed after it (NULL if none), and is read ahead.
+ * Returns 1 if the file could be opened, 0 otherwise.
+ */
+int assemble_file(char * file_name, char * next_file_name)
+{
+    file_buffer source;
+    output_files outputs;
+
+    /* with --low-memory the source is read line by line, and is never held in memory as a whole */
+    start_stage();
+    if (options.low_memory ? !open_file_stream(&source, file_name) : !load_file_buffer(&source, file_name))
+    {
+        printf("Couldn't open file %s\n", file_name);
+        return ERROR;
+    }
+    end_stage(STAGE_READ);
+    /* let the next file be read from the disk while this one is assembled */
+    if (next_file_name != NULL)
+        prefetch_file(next_file_name);
+    if (options.diagnostics_format == TEXT_DIAGNOSTICS)
+        printf("analyzing file %s...\n", file_name);
+    start_diagnostics(file_name);
+    IC = options.base_address;
+    set_global_file(file_name);
+    if (options.check_only)
+        return check_file(&source);
+    init_output_files(&outputs);
+    /*
+     * a source that was already analyzed with the same options gets the output files kept in the cache
+     * (unless its symbols are needed for the global index, or the source isn't held in memory)
+     */
+    if (options.cache_directory != NULL && !options.global_index && !options.low_memory &&
+        load_cached_outputs(&source, &outputs))
+    {
+        start_stage();
+        write_output_files(file_name, &outputs);
+        end_stage(STAGE_OUTPUT);
+        flush_diagnostics();
+        free_output_files(&outputs);
+        free_file_buffer(&source);
+        return 1;
+    }
+    if (assemble_source(&source, &outputs, file_name))
+    {
+        start_stage();
+        write_output_files(file_name, &outputs);
+        end_stage(STAGE_OUTPUT);
+        /* the cache key is made of the source only, so the outputs of a source that includes files aren't kept */
+        if (options.cache_directory != NULL && outputs.has_ob && !included_files)
+            store_cached_outputs(&source, &outputs);
+    }
+    flush_diagnostics();
+    free_output_files(&outputs);
+    free_file_buffer(&source);
+    return 1;
+}
+
+/*
+ * Analyzes the files given by the arguments, with the options that come before them, or serves runs with --serve.
+ * The rows and pools kept for reuse between files are not released, so a worker of a server (see serve.c)
+ * keeps them from one run to the next.
+ * Returns the exit status of the run.
+ */
+int run_assembler(int argc, char *argv[])
 {
-    int retval = 1, i = 1;
-    int ICF, DCF;
-    FILE *file;
+    int retval = 1, i, count, first, lists_found;
+    char ** names;
+    file_buffer * lists;
 
+    if ((first = parse_options(argc, argv)) < 0)
+        return ERROR;
+    if (options.serve_socket != NULL)
+        return serve(options.serve_socket, options.workers, run_assembler);
+    reset_timings();
+    /* from here on, the arguments are the file names that follow the options */
+    argc -= first - 1;
+    argv += first - 1;
     retval = given_files(argc);
     if (retval == 0)
     {
-        while (i < argc)
+        lists = (file_buffer *) malloc(argc * sizeof(file_buffer));
+        count = collect_file_names(argc, argv, &names, lists, &lists_found);
+        init_global_index();
+        for (i = 0; i < count; i++)
+        {
+            if (!assemble_file(names[i], i + 1 < count ? names[i + 1] : NULL))
+                retval = EXIT_FAILURE;
+        }
+        /* a list file that couldn't be read fails the run, after the files that were found are analyzed */
+        if (!lists_found)
+            retval = EXIT_FAILURE;
+        /* with the -g option, checks the entries and externals of all the files together, and fails the run on errors */
+        if (!report_global_index())
+            retval = EXIT_FAILURE;
+        free_global_index();
+        print_timings(count);
+        /* with the -w option, analyzes the files again whenever they change (the global index covers the first analysis only) */
+        if (options.watch)
         {
-            file = fopen(argv[i], "r");
-            if (!file)
-            {                
-				printf("Couldn't open file %s\n", argv[i]);
-                retval = ERROR;
-            }
-            else
-            {
-				printf("analyzing file %s...\n", argv[i]);
-				init_data_structures();
-                if (first_pass(file))
-                {
-                    ICF = IC;
-                    DCF = DC;
-                    add_to_data(ICF);
-                    IC = INITIAL_ADDRESS;
-                    DC = 0;
-                    rewind(file);
-                    if (second_pass(file)){
-						make_output_files(argv[i], ICF - INITIAL_ADDRESS, DCF); /* add creation of output files */	
-					}
-                }
-                free_data_structures();
-				fclose(file);
-            }
-            i++;
-			IC = INITIAL_ADDRESS;
-			DC = 0;
+            options.global_index = 0;
+            watch_files(names, count, assemble_file);
         }
+        free_file_names(argc, names, lists);
+        free(lists);
     }
     return retval;
 }
+
+int main(int argc, char *argv[])
+{
+    int retval;
+    char * server = getenv(SERVER_SOCKET_VARIABLE);
+
+    /* with a server running, the files are analyzed by the server (see serve.c) */
+    if (server != NULL && !runs_until_stopped(argc, argv) && (retval = forward_to_server(server, argc, argv)) >= 0)
+        return retval;
+    retval = run_assembler(argc, argv);
+    release_data_structures();
+    release_diagnostics();
+    return retval;
+}
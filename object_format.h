@@ -0,0 +1,38 @@
+#ifndef OBJECT_FORMAT
+#define OBJECT_FORMAT
+
+/*
+ * Layout of the binary object file (made with the -f bin option, in the .obj file).
+ * Every number is an unsigned 32 bit little endian word, and every table starts at a multiple of 4.
+ * The file starts with a header of OBJECT_HEADER_WORDS words, in the order of the offsets below, followed by:
+ * the code image (code size bytes), the data image (data size bytes, padded to a multiple of 4),
+ * the entries table and the externals table (two words per row - offset of the name in the string table,
+ * and value / address of use), the relocations table (two words per row - address of a code word that holds
+ * an absolute address, and the section that address points into - 0 for code, 1 for data),
+ * and the string table of '\0' terminated names.
+ */
+
+#define OBJECT_MAGIC "ASOB"
+#define OBJECT_VERSION 2
+
+#define OBJECT_MAGIC_OFFSET 0
+#define OBJECT_VERSION_OFFSET 4
+#define OBJECT_BASE_OFFSET 8 /* Address of the first code word */
+#define OBJECT_CODE_SIZE_OFFSET 12 /* ICF - size of the code image in bytes */
+#define OBJECT_DATA_SIZE_OFFSET 16 /* DCF - size of the data image in bytes */
+#define OBJECT_ENTRY_COUNT_OFFSET 20
+#define OBJECT_EXTERN_COUNT_OFFSET 24
+#define OBJECT_STRINGS_SIZE_OFFSET 28
+#define OBJECT_CODE_OFFSET 32 /* Offset in the file of the code image */
+#define OBJECT_DATA_OFFSET 36 /* Offset in the file of the data image */
+#define OBJECT_ENTRIES_OFFSET 40 /* Offset in the file of the entries table */
+#define OBJECT_EXTERNS_OFFSET 44 /* Offset in the file of the externals table */
+#define OBJECT_STRINGS_OFFSET 48 /* Offset in the file of the string table */
+#define OBJECT_RELOCATION_COUNT_OFFSET 52
+#define OBJECT_RELOCATIONS_OFFSET 56 /* Offset in the file of the relocations table */
+#define OBJECT_HEADER_WORDS 15
+
+#define OBJECT_HEADER_SIZE (OBJECT_HEADER_WORDS * 4)
+#define OBJECT_ROW_SIZE 8 /* Size of a row in the entries, externals and relocations tables */
+
+#endif
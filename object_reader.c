@@ -0,0 +1,183 @@
+/*
+This file holds functions to read binary object files (see object_format.h).
+The functions work on the object file in place - the caller reads or maps the whole file into memory,
+and every table is used directly from there, without copying.
+The image of a text .ob file can be read into an object image too, with read_text_object.
+*/
+
+#include <string.h>
+#include <stdlib.h>
+#include "constants.h"
+#include "object_reader.h"
+
+/* Returns the little endian word that starts at bytes */
+unsigned long read_object_word(unsigned char * bytes)
+{
+    return (unsigned long) bytes[0] | ((unsigned long) bytes[1] << 8) |
+           ((unsigned long) bytes[2] << 16) | ((unsigned long) bytes[3] << 24);
+}
+
+/* Checks that a table of size bytes at offset lies inside the object file */
+int valid_object_table(long length, unsigned long offset, unsigned long size)
+{
+    return offset <= (unsigned long) length && size <= (unsigned long) length - offset;
+}
+
+/*
+ * Checks that bytes hold a valid object file, and fills image with its header and tables.
+ * Returns 1 if valid, 0 otherwise.
+ */
+int open_object_image(object_image * image, unsigned char * bytes, long length)
+{
+    unsigned long code_offset, data_offset, entries_offset, externs_offset, relocations_offset, strings_offset;
+
+    if (length < OBJECT_HEADER_SIZE || memcmp(bytes, OBJECT_MAGIC, 4) != 0 ||
+        read_object_word(bytes + OBJECT_VERSION_OFFSET) != OBJECT_VERSION)
+        return 0;
+
+    image->bytes = bytes;
+    image->length = length;
+    image->base = read_object_word(bytes + OBJECT_BASE_OFFSET);
+    image->code_size = read_object_word(bytes + OBJECT_CODE_SIZE_OFFSET);
+    image->data_size = read_object_word(bytes + OBJECT_DATA_SIZE_OFFSET);
+    image->entry_count = read_object_word(bytes + OBJECT_ENTRY_COUNT_OFFSET);
+    image->extern_count = read_object_word(bytes + OBJECT_EXTERN_COUNT_OFFSET);
+    image->relocation_count = read_object_word(bytes + OBJECT_RELOCATION_COUNT_OFFSET);
+    image->strings_size = read_object_word(bytes + OBJECT_STRINGS_SIZE_OFFSET);
+    code_offset = read_object_word(bytes + OBJECT_CODE_OFFSET);
+    data_offset = read_object_word(bytes + OBJECT_DATA_OFFSET);
+    entries_offset = read_object_word(bytes + OBJECT_ENTRIES_OFFSET);
+    externs_offset = read_object_word(bytes + OBJECT_EXTERNS_OFFSET);
+    relocations_offset = read_object_word(bytes + OBJECT_RELOCATIONS_OFFSET);
+    strings_offset = read_object_word(bytes + OBJECT_STRINGS_OFFSET);
+
+    /* every table must be inside the file, and the names must be terminated inside the string table */
+    if (!valid_object_table(length, code_offset, image->code_size) || image->code_size % 4 != 0 ||
+        !valid_object_table(length, data_offset, image->data_size) ||
+        image->entry_count > (unsigned long) length / OBJECT_ROW_SIZE ||
+        !valid_object_table(length, entries_offset, image->entry_count * OBJECT_ROW_SIZE) ||
+        image->extern_count > (unsigned long) length / OBJECT_ROW_SIZE ||
+        !valid_object_table(length, externs_offset, image->extern_count * OBJECT_ROW_SIZE) ||
+        image->relocation_count > (unsigned long) length / OBJECT_ROW_SIZE ||
+        !valid_object_table(length, relocations_offset, image->relocation_count * OBJECT_ROW_SIZE) ||
+        !valid_object_table(length, strings_offset, image->strings_size) ||
+        (image->strings_size > 0 && bytes[strings_offset + image->strings_size - 1] != '\0'))
+        return 0;
+
+    image->code = bytes + code_offset;
+    image->data = bytes + data_offset;
+    image->entries = bytes + entries_offset;
+    image->externs = bytes + externs_offset;
+    image->relocations = bytes + relocations_offset;
+    image->strings = (char *) bytes + strings_offset;
+    return 1;
+}
+
+/* Returns the code word at the given index (the word at address base + 4 * index) */
+unsigned long object_code_word(object_image * image, unsigned long index)
+{
+    return read_object_word(image->code + 4 * index);
+}
+
+/* Returns the name of an entry in the table at index (NULL if not valid), and fills its value */
+char * object_entry(object_image * image, unsigned long index, unsigned long * value)
+{
+    unsigned long name = read_object_word(image->entries + index * OBJECT_ROW_SIZE);
+
+    *value = read_object_word(image->entries + index * OBJECT_ROW_SIZE + 4);
+    return name < image->strings_size ? image->strings + name : NULL;
+}
+
+/* Returns the name of an external label used in the table at index (NULL if not valid), and fills the address of use */
+char * object_extern(object_image * image, unsigned long index, unsigned long * address)
+{
+    unsigned long name = read_object_word(image->externs + index * OBJECT_ROW_SIZE);
+
+    *address = read_object_word(image->externs + index * OBJECT_ROW_SIZE + 4);
+    return name < image->strings_size ? image->strings + name : NULL;
+}
+
+/* Returns the address of the code word to relocate in the table at index, and fills the section it points into */
+unsigned long object_relocation(object_image * image, unsigned long index, unsigned long * section)
+{
+    *section = read_object_word(image->relocations + index * OBJECT_ROW_SIZE + 4);
+    return read_object_word(image->relocations + index * OBJECT_ROW_SIZE);
+}
+
+/* Returns the value of a hexadecimal digit, -1 if ch is not one */
+int hex_digit(char ch)
+{
+    if (ch >= '0' && ch <= '9')
+        return ch - '0';
+    if (ch >= 'A' && ch <= 'F')
+        return ch - 'A' + 10;
+    if (ch >= 'a' && ch <= 'f')
+        return ch - 'a' + 10;
+    return -1;
+}
+
+/*
+ * Reads the image of a .ob file - the header line with ICF and DCF, followed by lines of an address and
+ * the bytes at that address, in hexadecimal - into image. Only the code and data are filled, the tables are empty.
+ * The image is allocated into image->bytes, and must be freed by the caller. Returns 1 if valid, 0 otherwise,
+ * and TEXT_OBJECT_NO_MEMORY if there is no memory for the image (and then nothing is left allocated).
+ * The sizes in the header line are checked before the image is allocated - the code and data must fit in the
+ * address space together, so a header can't make the reader allocate more than that.
+ */
+int read_text_object(object_image * image, file_buffer * ob)
+{
+    long position, size = 0, byte, base = -1, code_size, data_size;
+    int digit;
+    char * data, * end, * start;
+
+    memset(image, 0, sizeof(object_image));
+    append_to_buffer(ob, "", 1); /* terminates the text */
+    data = ob->data;
+    code_size = strtol(data, &end, 10);
+    data_size = strtol(start = end, &end, 10);
+    if (end == data || end == start || code_size < 0 || data_size < 0 || code_size % 4 != 0 ||
+        code_size > MAX_ADDRESS + 1L || data_size > MAX_ADDRESS + 1L - code_size)
+        return 0;
+    if ((image->bytes = (unsigned char *) malloc(code_size + data_size + 1)) == NULL)
+        return TEXT_OBJECT_NO_MEMORY;
+
+    while (*end != '\0')
+    {
+        /* every line starts with an address, followed by the bytes in it */
+        while (*end == ' ' || *end == '\n')
+            end++;
+        if (*end == '\0')
+            break;
+        position = strtol(start = end, &end, 10);
+        if (end == start)
+            break;
+        if (base == -1)
+            base = position;
+        while (*end == ' ')
+        {
+            while (*end == ' ')
+                end++;
+            if (*end == '\n' || *end == '\0')
+                break;
+            /* the bytes are read digit by digit - there are many of them, and strtol is much slower */
+            for (byte = 0, start = end; (digit = hex_digit(*end)) >= 0; end++)
+                byte = 16 * byte + digit;
+            if (end == start || size >= code_size + data_size)
+                break;
+            image->bytes[size++] = (unsigned char) byte;
+        }
+    }
+    if (size != code_size + data_size || *end != '\0')
+    {
+        free(image->bytes);
+        image->bytes = NULL;
+        return 0;
+    }
+    image->length = size;
+    image->base = base == -1 ? INITIAL_ADDRESS : base;
+    image->code_size = code_size;
+    image->data_size = data_size;
+    image->code = image->bytes;
+    image->data = image->bytes + code_size;
+    return 1;
+}
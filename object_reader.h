@@ -0,0 +1,36 @@
+#ifndef OBJECT_READER
+#define OBJECT_READER
+
+#include "object_format.h"
+#include "file_buffer.h"
+
+#define TEXT_OBJECT_NO_MEMORY -1 /* Returned by read_text_object when there is no memory for the image */
+
+typedef struct object_image
+{
+    unsigned char * bytes; /* The whole object file, in memory (read or mapped by the caller) */
+    long length; /* Length of the object file */
+    unsigned long base; /* Address of the first code word */
+    unsigned long code_size; /* Size of the code image in bytes */
+    unsigned long data_size; /* Size of the data image in bytes */
+    unsigned long entry_count; /* Number of rows in the entries table */
+    unsigned long extern_count; /* Number of rows in the externals table */
+    unsigned long relocation_count; /* Number of rows in the relocations table */
+    unsigned char * code; /* The code image, inside bytes */
+    unsigned char * data; /* The data image, inside bytes */
+    unsigned char * entries; /* The entries table, inside bytes */
+    unsigned char * externs; /* The externals table, inside bytes */
+    unsigned char * relocations; /* The relocations table, inside bytes */
+    char * strings; /* The string table, inside bytes */
+    unsigned long strings_size; /* Size of the string table */
+} object_image;
+
+unsigned long read_object_word(unsigned char * bytes);
+int open_object_image(object_image * image, unsigned char * bytes, long length);
+unsigned long object_code_word(object_image * image, unsigned long index);
+char * object_entry(object_image * image, unsigned long index, unsigned long * value);
+char * object_extern(object_image * image, unsigned long index, unsigned long * address);
+unsigned long object_relocation(object_image * image, unsigned long index, unsigned long * section);
+int read_text_object(object_image * image, file_buffer * ob);
+
+#endif
@@ -0,0 +1,166 @@
+/*
+This file holds the command line options of the assembler.
+Options are given before the files to analyze, and are kept in a global structure used by the rest of the program.
+*/
+
+#include "options.h"
+#include "constants.h"
+
+#define DEFAULT_OPTIONS {NULL, DEFAULT_CACHE_LIMIT, 0, TEXT_FORMAT, INITIAL_ADDRESS, 0, 0, 0, 0, TEXT_DIAGNOSTICS, 0, WATCH_INTERVAL_MS, 0, NO_POOLING, 0, NULL, \
+                         SERVE_WORKERS}
+
+assembler_options options = DEFAULT_OPTIONS;
+
+/* Sets every option back to its default, before the options of another run are read (see serve.c) */
+void reset_options()
+{
+    assembler_options defaults = DEFAULT_OPTIONS;
+
+    options = defaults;
+}
+
+/*
+ * Reads the base address given to the -b option.
+ * The base address must be a multiple of 4 that fits the address field of a J instructive.
+ * Returns 1 if valid, 0 otherwise (and prints an error message).
+ */
+int valid_base_address(char * text)
+{
+    char * end;
+    long base = strtol(text, &end, 10);
+
+    if (*end != '\0' || end == text || base < 0 || base % 4 != 0 || base > MAX_BASE_ADDRESS)
+    {
+        printf("Illegal base address %s - must be a multiple of 4 between 0 and %d\n", text, MAX_BASE_ADDRESS);
+        return 0;
+    }
+    options.base_address = base;
+    return 1;
+}
+
+/*
+ * Reads the options from the beginning of the arguments.
+ * Returns the index of the first file name, or -1 if the options are not valid (and prints error messages).
+ */
+int parse_options(int argc, char *argv[])
+{
+    int i = 1;
+    char * end;
+
+    while (i < argc && argv[i][0] == '-')
+    {
+        if (!strcmp(argv[i], "-c") && i + 1 < argc)
+            options.cache_directory = argv[++i];
+        else if (!strcmp(argv[i], "--cache-limit") && i + 1 < argc)
+        {
+            if ((options.cache_limit = strtol(argv[++i], &end, 10)) <= 0 || *end != '\0')
+            {
+                printf("Illegal cache limit %s - must be a positive number of bytes\n", argv[i]);
+                return -1;
+            }
+        }
+        else if (!strcmp(argv[i], "-u"))
+            options.keep_unchanged = 1;
+        else if (!strcmp(argv[i], "-r"))
+            options.relocations = 1;
+        else if (!strcmp(argv[i], "-g"))
+            options.global_index = 1;
+        else if (!strcmp(argv[i], "-w"))
+        {
+            options.watch = 1;
+            options.keep_unchanged = 1; /* rewrite only the output files that change */
+        }
+        else if (!strcmp(argv[i], "--watch-interval") && i + 1 < argc)
+        {
+            if ((options.watch_interval = strtol(argv[++i], &end, 10)) <= 0 || *end != '\0')
+            {
+                printf("Illegal watch interval %s - must be a positive number of milliseconds\n", argv[i]);
+                return -1;
+            }
+        }
+        else if (!strcmp(argv[i], "--check"))
+            options.check_only = 1;
+        else if (!strcmp(argv[i], "--low-memory"))
+            options.low_memory = 1;
+        else if (!strcmp(argv[i], "--timings"))
+            options.timings = 1;
+        else if (!strcmp(argv[i], "--max-errors") && i + 1 < argc)
+        {
+            if ((options.max_errors = atoi(argv[++i])) <= 0)
+            {
+                printf("Illegal number of errors %s - must be a positive number\n", argv[i]);
+                return -1;
+            }
+        }
+        else if (!strcmp(argv[i], "--diagnostics") && i + 1 < argc && !strcmp(argv[i + 1], "text"))
+        {
+            options.diagnostics_format = TEXT_DIAGNOSTICS;
+            i++;
+        }
+        else if (!strcmp(argv[i], "--diagnostics") && i + 1 < argc && !strcmp(argv[i + 1], "machine"))
+        {
+            options.diagnostics_format = MACHINE_DIAGNOSTICS;
+            i++;
+        }
+        else if (!strcmp(argv[i], "--pool-strings") && i + 1 < argc && !strcmp(argv[i + 1], "same"))
+        {
+            options.pool_strings = POOL_SAME;
+            i++;
+        }
+        else if (!strcmp(argv[i], "--pool-strings") && i + 1 < argc && !strcmp(argv[i + 1], "suffix"))
+        {
+            options.pool_strings = POOL_SUFFIXES;
+            i++;
+        }
+        else if (!strcmp(argv[i], "--serve") && i + 1 < argc)
+            options.serve_socket = argv[++i];
+        else if (!strcmp(argv[i], "--workers") && i + 1 < argc)
+        {
+            if ((options.workers = atoi(argv[++i])) <= 0)
+            {
+                printf("Illegal number of workers %s - must be a positive number\n", argv[i]);
+                return -1;
+            }
+        }
+        else if (!strcmp(argv[i], "-b") && i + 1 < argc)
+        {
+            if (!valid_base_address(argv[++i]))
+                return -1;
+        }
+        else if (!strcmp(argv[i], "-f") && i + 1 < argc && !strcmp(argv[i + 1], "text"))
+        {
+            options.object_format = TEXT_FORMAT;
+            i++;
+        }
+        else if (!strcmp(argv[i], "-f") && i + 1 < argc && !strcmp(argv[i + 1], "bin"))
+        {
+            options.object_format = BINARY_FORMAT;
+            i++;
+        }
+        else
+        {
+            printf("Unknown option %s\n", argv[i]);
+            printf("Usage: assembler [-c cache_directory] [--cache-limit bytes] [-u] [-f text|bin] [-b base_address] [-r] [-g] [-w] [--watch-interval ms] [--check] [--low-memory] [--timings] [--max-errors N] [--diagnostics text|machine] [--pool-strings same|suffix] file... | @list_file...\n");
+            printf("       assembler --serve socket [--workers N]\n");
+            return -1;
+        }
+        i++;
+    }
+    /* the streamed object file is written in order from start to end, and the text format is the one made that way */
+    if (options.low_memory && options.object_format == BINARY_FORMAT)
+    {
+        printf("The --low-memory option makes text object files only, and can't be used with -f bin\n");
+        return -1;
+    }
+    return i;
+}
+
+/*
+ * Writes to key a string describing everything besides the source that affects the output files -
+ * the version of the assembler and the options that change the output.
+ */
+void options_key(char * key)
+{
+    sprintf(key, "assembler %s format %d base %d relocations %d pool %d", ASSEMBLER_VERSION, options.object_format,
+            options.base_address, options.relocations, options.pool_strings);
+}
@@ -0,0 +1,44 @@
+#ifndef OPTIONS
+#define OPTIONS
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "diagnostics.h"
+
+enum{TEXT_FORMAT, BINARY_FORMAT}; /* Formats of the object file */
+enum{NO_POOLING, POOL_SAME, POOL_SUFFIXES}; /* Pooling of labeled .asciz strings (--pool-strings same / suffix) */
+
+#define DEFAULT_CACHE_LIMIT 67108864L /* Default size the cache directory is kept under, in bytes */
+#define SERVE_WORKERS 4 /* Default number of processes serving runs with --serve */
+#define WATCH_INTERVAL_MS 100 /* Default time between two checks of the watched files with -w, in milliseconds */
+
+typedef struct assembler_options
+{
+    char * cache_directory; /* Directory of cached output files (-c), NULL if not used */
+    long cache_limit; /* Number of bytes the cache directory is kept under (--cache-limit), DEFAULT_CACHE_LIMIT by default */
+    int keep_unchanged; /* 1 if output files are written only when their content changed (-u), 0 otherwise */
+    int object_format; /* Format of the object file (-f text / -f bin) */
+    int base_address; /* Address of the first instruction (-b), INITIAL_ADDRESS by default */
+    int relocations; /* 1 if the .rel file of relocations is made (-r), 0 otherwise */
+    int global_index; /* 1 if entries and externals are checked across all the files (-g), 0 otherwise */
+    int check_only; /* 1 if the files are only checked for errors, without making output files (--check), 0 otherwise */
+    int max_errors; /* Number of errors after which a file is no longer analyzed (--max-errors), 0 for no limit */
+    int diagnostics_format; /* Format of errors and warnings (--diagnostics text / machine) */
+    int watch; /* 1 if the files are analyzed again whenever they change (-w), 0 otherwise */
+    long watch_interval; /* Milliseconds between two checks of the watched files (--watch-interval), WATCH_INTERVAL_MS by default */
+    int low_memory; /* 1 if the source is read and the object file is written as the file is assembled (--low-memory), 0 otherwise */
+    int pool_strings; /* Pooling of labeled .asciz strings with the same contents (--pool-strings), NO_POOLING by default */
+    int timings; /* 1 if the time spent in every stage is printed after the files are analyzed (--timings), 0 otherwise */
+    char * serve_socket; /* Socket the assembler serves runs on (--serve), NULL if it analyzes the given files itself */
+    int workers; /* Number of processes serving runs (--workers), SERVE_WORKERS by default */
+} assembler_options;
+
+extern assembler_options options;
+
+void reset_options();
+int valid_base_address(char * text);
+int parse_options(int argc, char *argv[]);
+void options_key(char * key);
+
+#endif
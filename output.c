@@ -1,192 +1,527 @@
 /* 
 File that holds functions to create the output files (if needed) - ext, ent and ob files.
-The file also translates the binary code to hexadecimal as needed for output
+The file also translates the binary code to hexadecimal as needed for output.
+Every output file is built in memory first, and then written to the disk at once.
+With --low-memory the .ob file is streamed instead - its code is written while the second pass encodes it,
+and its data is kept in a temporary file until the code is complete, and then appended after it
+(see open_output_stream). Only the tables of labels are kept in memory then.
 */
 
 #include "output.h"
 
-void forward_line(int address, FILE * file)
+#define STREAM_CHUNK_SIZE 65536 /* Text of the streamed .ob file collected before it is written */
+
+FILE * object_stream = NULL; /* The streamed .ob file (under a temporary name), NULL when not streaming */
+FILE * data_spool = NULL; /* Temporary file with the bytes of the data, while streaming */
+char * object_stream_name = NULL, * object_temp_name = NULL; /* Names of the streamed .ob file */
+file_buffer stream_chunk; /* Text of the streamed .ob file not written yet */
+int stream_address; /* Address of the next code word streamed */
+
+void forward_line(int address, file_buffer * output)
 {
     /* In case reached to an address that is a multiplication of 4, printing new line and the address */
+    char text[MAX_LINE_LENGTH];
 
-    fprintf(file, "\n");
-    fprintf(file, "0%d ", address);
+    sprintf(text, "\n0%d ", address);
+    append_string_to_buffer(output, text);
 }
 
-int print_code_hex(FILE * ob_file)
+void print_hex_byte(file_buffer * output, long word)
 {
+    /* Prints the least significant byte of word as two hex digits, followed by a space */
+    char text[4];
+
+    sprintf(text, "%lX%lX ", (word & 0xF0) >> 4, word & 0x0F); /* high nibble, low nibble */
+    append_to_buffer(output, text, 3);
+}
+
+void print_code_word(file_buffer * output, int address, long word)
+{
+    /* Prints the line of a code word - its address, and its bytes */
     int i;
-    long word;
-    int address = 100;
+    char text[MAX_LINE_LENGTH];
+
+    if ((address % 4) == 0)
+        append_string_to_buffer(output, "\n");
+    sprintf(text, "0%d ", address);
+    append_string_to_buffer(output, text);
+
+    for (i = 0; i < 4; i++)
+    {
+        print_hex_byte(output, word);
+        /* finished 1 byte, now shift right 8 bit to get the next byte */
+        word >>= 8;
+    }
+}
+
+int print_data_bytes(file_buffer * output, int address, long word, int bytes)
+{
+    /* Prints the given number of least significant bytes of a data word, starting a new line every 4 addresses */
+    int i;
+
+    for (i = 0; i < bytes; i++)
+    {
+        print_hex_byte(output, word);
+        /* finished 1 byte, now shift right 8 bit to get the next byte */
+        word >>= 8;
+
+        address++;
+        if ((address % 4) == 0)
+            forward_line(address, output);
+    }
+    return address;
+}
+
+int print_code_hex(file_buffer * output)
+{
+    int address = options.base_address;
     code_row_ptr code_head;
     get_code_head(&code_head);
 
     while (code_head != NULL)
     {
-        if ((address % 4) == 0)
-            fprintf(ob_file, "\n");
-
-        word = code_head->word;
-        fprintf(ob_file, "0%d ", address);
+        print_code_word(output, address, code_head->word);
         address += 4;
-
-        for (i = 0; i < 4; i++)
-        {
-            fprintf(ob_file,"%lX",(word & 0xF0) >> 4); /* high nibble */
-            fprintf(ob_file,"%lX ",word & 0x0F); /* low nibble */
-            /* finished 1 byte, now shift right 8 bit to get the next byte */
-            word >>= 8;
-        }
         code_head = code_head->next;
     }
     return address;
 }
 
-void print_data_hex(FILE * ob_file, int address)
+void print_data_hex(file_buffer * output, int address)
 {
-    int i;
+    long i;
     code_row_ptr code_head;
     get_data_head(&code_head);
 
     if ((address % 4) == 0)
-        forward_line(address, ob_file);
+        forward_line(address, output);
 
     while (code_head != NULL)
     {
-        if (!strcmp(code_head->type, "word"))
-        {
-            long word = code_head->word;
-            for (i = 0; i < 4; i++)
-            {
-                fprintf(ob_file,"%lX",(word & 0xF0) >> 4); /* high nibble */
-                fprintf(ob_file,"%lX ",word & 0x0F); /* low nibble */
-                /* finished 1 byte, now shift right 8 bit to get the next byte */
-                word >>= 8;
-
-                address++;
-                if ((address % 4) == 0)
-                    forward_line(address, ob_file);
-            }
-        }
-        else if (!strcmp(code_head->type, "half_word"))
+        /* the bytes of an included file are printed one by one, and a row of .space or .fill count times */
+        for (i = 0; i < code_head->count; i++)
         {
-            long word = code_head->word;
-            for (i = 0; i < 2; i++)
-            {
-                fprintf(ob_file,"%lX",(word & 0xF0) >> 4); /* high nibble */
-                fprintf(ob_file,"%lX ",word & 0x0F); /* low nibble */
-                /* finished 1 byte, now shift right 8 bit to get the next byte */
-                word >>= 8;
-
-                address++;
-                if ((address % 4) == 0)
-                    forward_line(address, ob_file);
-            }
+            if (code_head->bytes != NULL)
+                address = print_data_bytes(output, address, (unsigned char) code_head->bytes[i], 1);
+            else if (!strcmp(code_head->type, "word"))
+                address = print_data_bytes(output, address, code_head->word, 4);
+            else if (!strcmp(code_head->type, "half_word"))
+                address = print_data_bytes(output, address, code_head->word, 2);
+            else if (!strcmp(code_head->type, "byte"))
+                address = print_data_bytes(output, address, code_head->word, 1);
         }
+        code_head = code_head->next;
+    }
+}
 
-        else if (!strcmp(code_head->type, "byte"))
-        {
-            long word = code_head->word;
+char * output_file_name(char * file_name, char * extension)
+{
+    /* Returns a newly allocated copy of file_name with the given extension appended */
+    char * name = (char *) malloc(strlen(file_name) + strlen(extension) + 1);
 
-            fprintf(ob_file,"%lX",(word & 0xF0) >> 4); /* high nibble */
-            fprintf(ob_file,"%lX ",word & 0x0F); /* low nibble */
+    strcpy(name, file_name);
+    strcat(name, extension);
+    return name;
+}
 
-            address++;
-            if ((address % 4) == 0)
-                forward_line(address, ob_file);
-        }
-        code_head = code_head->next;
-    }
+void write_output_file(file_buffer * output, char * file_name, char * extension)
+{
+    int written;
+    char * name = output_file_name(file_name, extension);
+
+    /* with the -u option, files that didn't change are not written again */
+    if (options.keep_unchanged)
+        written = replace_file_buffer(output, name);
+    else
+        written = write_file_buffer(output, name);
+    if (!written)
+        printf("Couldn't write output file %s\n", name);
+    free(name);
+}
+
+void remove_output_file(char * file_name, char * extension)
+{
+    /* Removes an output file left from a previous run, that isn't made anymore */
+    char * name = output_file_name(file_name, extension);
+
+    remove(name);
+    free(name);
+}
+
+void init_output_files(output_files * outputs)
+{
+    init_file_buffer(&outputs->ob);
+    init_file_buffer(&outputs->ext);
+    init_file_buffer(&outputs->ent);
+    init_file_buffer(&outputs->rel);
+    outputs->has_ob = 0;
+    outputs->has_ext = 0;
+    outputs->has_ent = 0;
+    outputs->has_rel = 0;
+}
+
+void free_output_files(output_files * outputs)
+{
+    free_file_buffer(&outputs->ob);
+    free_file_buffer(&outputs->ext);
+    free_file_buffer(&outputs->ent);
+    free_file_buffer(&outputs->rel);
 }
 
-void make_ext_file(char * file_name)
+void make_ext_file(output_files * outputs)
 {
     /* Makes the .ext file (If needed) */
 
     external_row_ptr ext_head;
     get_external_head(&ext_head);
 
+    outputs->has_ext = (ext_head != NULL);
     if (ext_head != NULL)
     {
-        FILE * ext_file;
-        char * ext_file_name = (char *) malloc((strlen(file_name) + 4) * sizeof(char));
-
-        strcpy(ext_file_name, file_name);
-        strcat(ext_file_name, ".ext");
-        ext_file = fopen(ext_file_name, "w");
+        char text[MAX_LINE_LENGTH + MAX_LABEL_LENGTH];
 
         while (ext_head != NULL)
         {
-            fprintf(ext_file, "%s 0%d\n", ext_head->symbol, ext_head->address);
+            sprintf(text, "%s 0%d\n", interned_name(ext_head->id), ext_head->address);
+            append_string_to_buffer(&outputs->ext, text);
             ext_head = ext_head->next;
         }
-        fclose(ext_file);
     }
 }
 
-void make_ent_file(char * file_name)
+void make_ent_file(output_files * outputs)
 {
-    /* Makes the .ext output file (If needed) */
-    int entry_occ = 0;
-    row_ptr symbol_head;
-    get_symbol_head(&symbol_head);
+    /* Makes the .ent output file (If needed), from the index of entries kept by the symbol table */
+    int i, entry_count;
+    char text[MAX_LINE_LENGTH + MAX_LABEL_LENGTH];
+    row_ptr * entry_rows;
+
+    entry_count = get_entry_rows(&entry_rows);
+    outputs->has_ent = (entry_count > 0);
+    for (i = 0; i < entry_count; i++)
+    {
+        sprintf(text, "%s 0%d\n", interned_name(entry_rows[i]->id), symbol_address(entry_rows[i]));
+        append_string_to_buffer(&outputs->ent, text);
+    }
+}
+
+void make_rel_file(output_files * outputs)
+{
+    /*
+     * Makes the .rel output file (with the -r option) - the address of every code word that holds
+     * the absolute address of a label, and the section of the label.
+     * The file is made even if it is empty, since it tells there is nothing to relocate.
+     */
+    char text[MAX_LINE_LENGTH];
+    relocation_row_ptr rel_head;
+    get_relocation_head(&rel_head);
+
+    outputs->has_rel = 1;
+    while (rel_head != NULL)
+    {
+        sprintf(text, "0%d %s\n", rel_head->address, rel_head->section == DATA_SECTION ? "data" : "code");
+        append_string_to_buffer(&outputs->rel, text);
+        rel_head = rel_head->next;
+    }
+}
+
+void make_ob_file(output_files * outputs, int ICF, int DCF)
+{
+    int address;
+    char text[MAX_LINE_LENGTH];
 
+    sprintf(text, "     %d %d     ", ICF, DCF);
+    append_string_to_buffer(&outputs->ob, text);
 
-    /* First, count the number of occurences of "entry" existence, to determine whether to open a file */
-    while (symbol_head != NULL)
+    address = print_code_hex(&outputs->ob);
+    print_data_hex(&outputs->ob, address);
+}
+
+void append_object_word(file_buffer * output, unsigned long word, int bytes)
+{
+    /* Appends the given number of least significant bytes of word, in little endian order */
+    char text[4];
+    int i;
+
+    for (i = 0; i < bytes; i++)
     {
-        if ((!strcmp(symbol_head->attributes, "code,entry")) || (!strcmp(symbol_head->attributes, "data,entry")))
-            entry_occ++;
-        symbol_head = symbol_head->next;
+        text[i] = (char) (word & MASK_8_BITS);
+        word >>= 8;
     }
+    append_to_buffer(output, text, bytes);
+}
+
+void set_object_word(file_buffer * output, long offset, unsigned long word)
+{
+    /* Overwrites a word that was already appended at the given offset */
+    int i;
 
-    if (entry_occ > 0)
+    for (i = 0; i < 4; i++)
     {
-	FILE * ent_file;
-	char * ent_file_name;
-        get_symbol_head(&symbol_head); /* Rewind head to the start */
-        
-        ent_file_name = (char *) malloc((strlen(file_name) + 4) * sizeof(char));
+        output->data[offset + i] = (char) (word & MASK_8_BITS);
+        word >>= 8;
+    }
+}
+
+long object_string(file_buffer * strings, long * string_offsets, int id)
+{
+    /* Returns the offset of an interned name in the string table, appending it the first time it is used */
+    char * name;
 
-        strcpy(ent_file_name, file_name);
-        strcat(ent_file_name, ".ent");
+    if (string_offsets[id] < 0)
+    {
+        name = interned_name(id);
+        string_offsets[id] = strings->length;
+        append_to_buffer(strings, name, strlen(name) + 1);
+    }
+    return string_offsets[id];
+}
 
-        ent_file = fopen(ent_file_name, "w");
+void make_object_file(output_files * outputs, int ICF, int DCF)
+{
+    /* Makes the binary object file (.obj), in the layout described in object_format.h */
+    int i, entry_count = 0, extern_count = 0, relocation_count = 0;
+    long j;
+    file_buffer * output = &outputs->ob;
+    file_buffer strings;
+    long * string_offsets; /* Offset of every interned name in the string table, -1 until it is appended */
+    code_row_ptr code_row;
+    row_ptr * entry_rows;
+    external_row_ptr ext_row;
+    relocation_row_ptr rel_row;
+
+    init_file_buffer(&strings);
+    string_offsets = (long *) malloc((interned_count() + 1) * sizeof(long));
+    for (i = 0; i < interned_count(); i++)
+        string_offsets[i] = -1;
+    append_to_buffer(output, OBJECT_MAGIC, 4);
+    append_object_word(output, OBJECT_VERSION, 4);
+    append_object_word(output, options.base_address, 4);
+    append_object_word(output, ICF, 4);
+    append_object_word(output, DCF, 4);
+    for (i = OBJECT_ENTRY_COUNT_OFFSET; i < OBJECT_HEADER_SIZE; i += 4)
+        append_object_word(output, 0, 4); /* filled below, once the tables are made */
+
+    set_object_word(output, OBJECT_CODE_OFFSET, output->length);
+    get_code_head(&code_row);
+    while (code_row != NULL)
+    {
+        append_object_word(output, code_row->word, 4);
+        code_row = code_row->next;
+    }
 
-        while (symbol_head != NULL)
+    set_object_word(output, OBJECT_DATA_OFFSET, output->length);
+    get_data_head(&code_row);
+    while (code_row != NULL)
+    {
+        /*
+         * the data of the object file is flat - the bytes of an included file are copied at once,
+         * and a row of .space or .fill is appended count times
+         */
+        if (code_row->bytes != NULL)
+            append_to_buffer(output, code_row->bytes, code_row->count);
+        else
         {
-            if ((!strcmp(symbol_head->attributes, "code,entry")) || (!strcmp(symbol_head->attributes, "data,entry")))
-                fprintf(ent_file, "%s 0%d\n", symbol_head->symbol, symbol_head->value);
-            symbol_head = symbol_head->next;
+            for (j = 0; j < code_row->count; j++)
+            {
+                if (!strcmp(code_row->type, "word"))
+                    append_object_word(output, code_row->word, 4);
+                else if (!strcmp(code_row->type, "half_word"))
+                    append_object_word(output, code_row->word, 2);
+                else if (!strcmp(code_row->type, "byte"))
+                    append_object_word(output, code_row->word, 1);
+            }
         }
-        fclose(ent_file);
+        code_row = code_row->next;
     }
+    while (output->length % 4 != 0)
+        append_object_word(output, 0, 1);
+
+    set_object_word(output, OBJECT_ENTRIES_OFFSET, output->length);
+    entry_count = get_entry_rows(&entry_rows);
+    for (i = 0; i < entry_count; i++)
+    {
+        append_object_word(output, object_string(&strings, string_offsets, entry_rows[i]->id), 4);
+        append_object_word(output, symbol_address(entry_rows[i]), 4);
+    }
+
+    set_object_word(output, OBJECT_EXTERNS_OFFSET, output->length);
+    get_external_head(&ext_row);
+    while (ext_row != NULL)
+    {
+        append_object_word(output, object_string(&strings, string_offsets, ext_row->id), 4);
+        append_object_word(output, ext_row->address, 4);
+        extern_count++;
+        ext_row = ext_row->next;
+    }
+
+    set_object_word(output, OBJECT_RELOCATIONS_OFFSET, output->length);
+    get_relocation_head(&rel_row);
+    while (rel_row != NULL)
+    {
+        append_object_word(output, rel_row->address, 4);
+        append_object_word(output, rel_row->section, 4);
+        relocation_count++;
+        rel_row = rel_row->next;
+    }
+
+    set_object_word(output, OBJECT_STRINGS_OFFSET, output->length);
+    append_to_buffer(output, strings.data, strings.length);
+
+    set_object_word(output, OBJECT_ENTRY_COUNT_OFFSET, entry_count);
+    set_object_word(output, OBJECT_EXTERN_COUNT_OFFSET, extern_count);
+    set_object_word(output, OBJECT_RELOCATION_COUNT_OFFSET, relocation_count);
+    set_object_word(output, OBJECT_STRINGS_SIZE_OFFSET, strings.length);
+    free_file_buffer(&strings);
+    free(string_offsets);
 }
 
-void make_ob_file(char * file_name, int ICF, int DCF)
+void flush_stream_chunk(int all)
 {
-    int address;
-    code_row_ptr code_head;
-    FILE * ob_file;
-    char *  ob_file_name = (char*) malloc((strlen(file_name) + 3) * sizeof(char));
+    /* Writes the text collected for the streamed .ob file, once there is enough of it (or all of it) */
+    if (stream_chunk.length > 0 && (all || stream_chunk.length >= STREAM_CHUNK_SIZE))
+    {
+        fwrite(stream_chunk.data, 1, stream_chunk.length, object_stream);
+        stream_chunk.length = 0;
+    }
+}
 
-    strcpy(ob_file_name, file_name);
-    strcat(ob_file_name, ".ob");
+/*
+ * Starts streaming the .ob file of file_name (with --low-memory), once the first pass found ICF and DCF.
+ * Until close_output_stream, the code words are written to it as they are added, and the data is kept
+ * in a temporary file. Returns 1 on success, 0 if the files couldn't be made (and prints an error message).
+ */
+int open_output_stream(char * file_name, int ICF, int DCF)
+{
+    char text[MAX_LINE_LENGTH];
+
+    /* the file is written under a temporary name, so a file with errors leaves the previous .ob file as it was */
+    object_stream_name = output_file_name(file_name, ".ob");
+    object_temp_name = temp_file_name(object_stream_name);
+    object_stream = fopen(object_temp_name, "w");
+    data_spool = tmpfile();
+    if (object_stream == NULL || data_spool == NULL)
+    {
+        printf("Couldn't write output file %s\n", object_stream_name);
+        close_output_stream(0);
+        return 0;
+    }
+    init_file_buffer(&stream_chunk);
+    sprintf(text, "     %d %d     ", ICF, DCF);
+    append_string_to_buffer(&stream_chunk, text);
+    stream_address = options.base_address;
+    return 1;
+}
 
-    ob_file = fopen(ob_file_name, "w");
-    fprintf(ob_file, "     %d %d     ", ICF, DCF);
+/* Returns 1 while the .ob file is streamed, 0 otherwise */
+int output_streamed()
+{
+    return object_stream != NULL;
+}
 
-    
-    get_code_head(&code_head);
+/* Writes a code word to the streamed .ob file */
+void stream_code_word(unsigned long word)
+{
+    print_code_word(&stream_chunk, stream_address, word);
+    stream_address += 4;
+    flush_stream_chunk(0);
+}
+
+/* Keeps the given number of least significant bytes of a data word, until the data is appended to the .ob file */
+void spool_data_bytes(unsigned long word, int bytes)
+{
+    int i;
+
+    for (i = 0; i < bytes; i++)
+    {
+        putc((int) (word & MASK_8_BITS), data_spool);
+        word >>= 8;
+    }
+}
 
-    address = print_code_hex(ob_file);
-    print_data_hex(ob_file, address);
+/* Keeps a block of data bytes (of an included file), until the data is appended to the .ob file */
+void spool_data_block(char * bytes, long length)
+{
+    fwrite(bytes, 1, length, data_spool);
+}
 
+/*
+ * Ends streaming the .ob file. If valid is 1, the data is appended after the code, and the file is renamed
+ * into its place. Otherwise the file is removed. Returns 1 if the file was written, 0 otherwise.
+ */
+int close_output_stream(int valid)
+{
+    int ch, address = stream_address;
+
+    if (valid)
+    {
+        if ((address % 4) == 0)
+            forward_line(address, &stream_chunk);
+        rewind(data_spool);
+        while ((ch = getc(data_spool)) != EOF)
+        {
+            address = print_data_bytes(&stream_chunk, address, ch, 1);
+            flush_stream_chunk(0);
+        }
+        flush_stream_chunk(1);
+        if (ferror(object_stream) || ferror(data_spool))
+            valid = 0;
+    }
+    if (object_stream != NULL && fclose(object_stream) != 0)
+        valid = 0;
+    if (data_spool != NULL)
+        fclose(data_spool);
+    if (object_stream != NULL && (!valid || rename(object_temp_name, object_stream_name) != 0))
+    {
+        if (valid)
+            printf("Couldn't write output file %s\n", object_stream_name);
+        remove(object_temp_name);
+        valid = 0;
+    }
+    free_file_buffer(&stream_chunk);
+    free(object_stream_name);
+    free(object_temp_name);
+    object_stream = data_spool = NULL;
+    object_stream_name = object_temp_name = NULL;
+    return valid;
+}
+
+/*
+ * Makes the content of all the output files in memory, from the tables filled by the two passes.
+ * With the -f bin option, the binary object file is made instead of the .ob file.
+ * While the .ob file is streamed (with --low-memory), only the other files are made.
+ */
+void make_output_files(output_files * outputs, int ICF, int DCF)
+{
+    /* a streamed .ob file was already written while the file was assembled */
+    outputs->has_ob = !output_streamed();
+    if (outputs->has_ob && options.object_format == BINARY_FORMAT)
+        make_object_file(outputs, ICF, DCF);
+    else if (outputs->has_ob)
+        make_ob_file(outputs, ICF, DCF);
+    make_ext_file(outputs);
+    make_ent_file(outputs);
+    if (options.relocations)
+        make_rel_file(outputs);
 }
 
-void make_output_files(char * file_name, int ICF, int DCF)
+/*
+ * Writes the output files made by make_output_files. The .ext and .ent files are written only if needed,
+ * and the .ob file only if it wasn't streamed.
+ * With the -u option, .ext and .ent files of a previous run are removed if they are not needed anymore.
+ */
+void write_output_files(char * file_name, output_files * outputs)
 {
-    make_ob_file(file_name, ICF, DCF);
-    make_ext_file(file_name);
-    make_ent_file(file_name);
+    if (outputs->has_ob)
+        write_output_file(&outputs->ob, file_name, options.object_format == BINARY_FORMAT ? ".obj" : ".ob");
+    if (outputs->has_ext)
+        write_output_file(&outputs->ext, file_name, ".ext");
+    else if (options.keep_unchanged)
+        remove_output_file(file_name, ".ext");
+    if (outputs->has_ent)
+        write_output_file(&outputs->ent, file_name, ".ent");
+    else if (options.keep_unchanged)
+        remove_output_file(file_name, ".ent");
+    if (outputs->has_rel)
+        write_output_file(&outputs->rel, file_name, ".rel");
 }
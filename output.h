@@ -5,7 +5,33 @@
 #include "utils.h"
 #include "first_pass.h"
 #include "external_data_structure.h"
+#include "relocation_data_structure.h"
+#include "file_buffer.h"
+#include "options.h"
+#include "object_format.h"
+#include "intern_pool.h"
 
-void make_output_files(char * , int, int);
+typedef struct output_files
+{
+    file_buffer ob; /* Content of the .ob file (or the .obj file, with the -f bin option) */
+    int has_ob; /* 1 if the .ob file was made in ob, 0 if it wasn't made or was streamed (with --low-memory) */
+    file_buffer ext; /* Content of the .ext file */
+    int has_ext; /* 1 if there are externals and the .ext file is needed, 0 otherwise */
+    file_buffer ent; /* Content of the .ent file */
+    int has_ent; /* 1 if there are entries and the .ent file is needed, 0 otherwise */
+    file_buffer rel; /* Content of the .rel file */
+    int has_rel; /* 1 if the .rel file is needed (with the -r option), 0 otherwise */
+} output_files;
+
+void init_output_files(output_files * outputs);
+void free_output_files(output_files * outputs);
+void make_output_files(output_files * outputs, int ICF, int DCF);
+void write_output_files(char * file_name, output_files * outputs);
+int open_output_stream(char * file_name, int ICF, int DCF);
+int output_streamed();
+void stream_code_word(unsigned long word);
+void spool_data_bytes(unsigned long word, int bytes);
+void spool_data_block(char * bytes, long length);
+int close_output_stream(int valid);
 
 #endif
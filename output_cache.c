@@ -0,0 +1,260 @@
+/*
+This file holds the cache of output files (used with the -c option).
+The output files of every valid source are kept in the cache directory, keyed by hashes of the source
+and of the options, so a source that didn't change since it was last analyzed is not analyzed again.
+Every key has an entry of its own, named by the whole key. The size of the cache directory is kept under
+--cache-limit bytes: the modification time of an entry is its last use (an entry used again is touched), and
+once the entries add up to more than the limit, the least recently used ones are removed until they add up to
+CACHE_TRIM_PERCENT of it. Counting the entries means reading the whole directory, so a run counts them once, when
+it first keeps an entry, and then adds up the entries it keeps itself - the directory is counted again only
+when that sum goes over the limit.
+An entry keeps the diagnostics of the source too (only warnings - a source with errors has no outputs), and they
+are written again when the entry is used, so a source taken from the cache shows the same warnings.
+An entry is written to a temporary file and renamed into place, so concurrent runs of the assembler never
+see an entry that is partly written.
+*/
+
+#define _POSIX_C_SOURCE 200809L /* For getpid, directories, and file times in nanoseconds */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "output_cache.h"
+#include "options.h"
+#include "constants.h"
+#include "diagnostics.h"
+
+#define CACHE_SUFFIX ".cache" /* End of the name of every cache entry */
+#define CACHE_TRIM_PERCENT 90 /* Share of the limit the entries are trimmed to once they go over it */
+#define MAX_ENTRY_NAME_LENGTH 64 /* Upper bound for the length of the name of an entry, after its directory */
+#define INITIAL_CACHE_ENTRIES 64 /* Number of entries trim_cache has room for on its first allocation */
+#define CACHE_MAGIC "asmcache" /* Start of every cache entry */
+#define MASK_32_BITS 0xFFFFFFFFUL
+#define FNV_OFFSET 2166136261UL /* Initial value of the FNV-1a hash */
+#define FNV_PRIME 16777619UL
+#define MAX_HEADER_LENGTH 128 /* Upper bound for the length of the header line of an entry */
+#define CACHED_FILES 4 /* Number of output files kept in an entry - .ob, .ext, .ent and .rel */
+
+typedef struct cache_entry
+{
+    char * name;
+    long size;
+    struct timespec used; /* Last use of the entry - its modification time */
+} cache_entry;
+
+long cache_total = -1; /* Size of the entries as last counted, and the entries kept since, -1 before counting */
+
+/* Adds bytes to the two hashes of a key - FNV-1a and sdbm */
+void hash_bytes(cache_key * key, char * bytes, long length)
+{
+    long i;
+    unsigned long byte;
+
+    for (i = 0; i < length; i++)
+    {
+        byte = (unsigned char) bytes[i];
+        key->first = ((key->first ^ byte) * FNV_PRIME) & MASK_32_BITS;
+        key->second = (byte + (key->second << 6) + (key->second << 16) - key->second) & MASK_32_BITS;
+    }
+}
+
+void make_cache_key(file_buffer * source, cache_key * key)
+{
+    char options_text[MAX_LINE_LENGTH];
+
+    options_key(options_text);
+    key->first = FNV_OFFSET;
+    key->second = 0;
+    hash_bytes(key, options_text, strlen(options_text) + 1);
+    hash_bytes(key, source->data, source->length);
+    key->length = source->length;
+}
+
+/* Returns a newly allocated name of the cache entry a key belongs to */
+char * cache_entry_name(cache_key * key)
+{
+    char * name = (char *) malloc(strlen(options.cache_directory) + MAX_ENTRY_NAME_LENGTH);
+
+    sprintf(name, "%s/%08lx%08lx%lx%s", options.cache_directory, key->first, key->second, key->length, CACHE_SUFFIX);
+    return name;
+}
+
+/* Orders cache entries from the least recently used one (by name between entries used at the same time) */
+int compare_cache_entries(const void * first, const void * second)
+{
+    const cache_entry * a = (const cache_entry *) first, * b = (const cache_entry *) second;
+
+    if (a->used.tv_sec != b->used.tv_sec)
+        return a->used.tv_sec < b->used.tv_sec ? -1 : 1;
+    if (a->used.tv_nsec != b->used.tv_nsec)
+        return a->used.tv_nsec < b->used.tv_nsec ? -1 : 1;
+    return strcmp(a->name, b->name);
+}
+
+/*
+ * Counts the size of the entries in the cache directory, and if it is over the limit removes the least recently
+ * used entries until the rest fit in CACHE_TRIM_PERCENT of the limit. Entries another run removes meanwhile are skipped.
+ */
+void trim_cache()
+{
+    DIR * directory;
+    struct dirent * file;
+    struct stat status;
+    cache_entry * entries = NULL;
+    long count = 0, capacity = 0, total = 0, i, length, suffix = strlen(CACHE_SUFFIX), trimmed;
+    char * name;
+
+    if ((directory = opendir(options.cache_directory)) == NULL)
+        return;
+    while ((file = readdir(directory)) != NULL)
+    {
+        length = strlen(file->d_name);
+        if (length <= suffix || strcmp(file->d_name + length - suffix, CACHE_SUFFIX))
+            continue;
+        name = (char *) malloc(strlen(options.cache_directory) + length + 2);
+        sprintf(name, "%s/%s", options.cache_directory, file->d_name);
+        if (stat(name, &status) != 0)
+        {
+            free(name);
+            continue;
+        }
+        if (count == capacity)
+        {
+            capacity = capacity ? 2 * capacity : INITIAL_CACHE_ENTRIES;
+            entries = (cache_entry *) realloc(entries, capacity * sizeof(cache_entry));
+        }
+        entries[count].name = name;
+        entries[count].size = status.st_size;
+        entries[count].used = status.st_mtim;
+        total += status.st_size;
+        count++;
+    }
+    closedir(directory);
+
+    if (total > options.cache_limit)
+    {
+        trimmed = options.cache_limit / 100 * CACHE_TRIM_PERCENT + options.cache_limit % 100 * CACHE_TRIM_PERCENT / 100;
+        qsort(entries, count, sizeof(cache_entry), compare_cache_entries);
+        for (i = 0; i < count && total > trimmed; i++)
+            if (remove(entries[i].name) == 0)
+                total -= entries[i].size;
+    }
+    cache_total = total;
+    for (i = 0; i < count; i++)
+        free(entries[i].name);
+    free(entries);
+}
+
+/*
+ * Fills the buffers of the output files kept in a cache entry, in the order they are kept,
+ * and pointers to the flags telling if they are made.
+ */
+void cached_files(output_files * outputs, file_buffer * files[], int * made[])
+{
+    files[0] = &outputs->ob;
+    made[0] = &outputs->has_ob;
+    files[1] = &outputs->ext;
+    made[1] = &outputs->has_ext;
+    files[2] = &outputs->ent;
+    made[2] = &outputs->has_ent;
+    files[3] = &outputs->rel;
+    made[3] = &outputs->has_rel;
+}
+
+/*
+ * Looks for the output files of a source in the cache.
+ * Returns 1, fills outputs and adds the diagnostics kept with them if they were found, 0 otherwise.
+ */
+int load_cached_outputs(file_buffer * source, output_files * outputs)
+{
+    int i, found = 0, * made[CACHED_FILES];
+    cache_key key, entry_key;
+    long lengths[CACHED_FILES], records_length, total, start = 0;
+    char magic[MAX_LABEL_LENGTH], * name;
+    file_buffer entry, * files[CACHED_FILES];
+
+    make_cache_key(source, &key);
+    name = cache_entry_name(&key);
+    if (load_file_buffer(&entry, name))
+    {
+        /* the header ends with the first '\n', and is followed by the content of the files */
+        while (start < entry.length && start < MAX_HEADER_LENGTH && entry.data[start] != '\n')
+            start++;
+        if (start < entry.length && entry.data[start] == '\n')
+        {
+            entry.data[start++] = '\0';
+            /* a negative length marks a file that isn't made for this source */
+            total = -1;
+            if (sscanf(entry.data, "%31s %lx %lx %ld %ld %ld %ld %ld %ld", magic, &entry_key.first,
+                       &entry_key.second, &entry_key.length, &lengths[0], &lengths[1], &lengths[2], &lengths[3],
+                       &records_length) == 5 + CACHED_FILES && records_length >= 0)
+                for (i = 0, total = start + records_length; i < CACHED_FILES; i++)
+                    total += lengths[i] > 0 ? lengths[i] : 0;
+            if (total == entry.length && !strcmp(magic, CACHE_MAGIC) && entry_key.first == key.first
+                && entry_key.second == key.second && entry_key.length == key.length && lengths[0] >= 0)
+            {
+                cached_files(outputs, files, made);
+                for (i = 0; i < CACHED_FILES; i++)
+                {
+                    (*made[i]) = (lengths[i] >= 0);
+                    if (lengths[i] > 0)
+                    {
+                        append_to_buffer(files[i], entry.data + start, lengths[i]);
+                        start += lengths[i];
+                    }
+                }
+                replay_diagnostics(entry.data + start, records_length);
+                /* the entry was just used, so it is the last one to be removed */
+                utimensat(AT_FDCWD, name, NULL, 0);
+                found = 1;
+            }
+        }
+        free_file_buffer(&entry);
+    }
+    free(name);
+    return found;
+}
+
+/*
+ * Keeps the output files and the diagnostics of a source in the cache, and removes the least recently used entries
+ * if the cache goes over its limit.
+ */
+void store_cached_outputs(file_buffer * source, output_files * outputs)
+{
+    int i, * made[CACHED_FILES];
+    cache_key key;
+    char header[MAX_HEADER_LENGTH], * name, * temp_name;
+    file_buffer entry, * files[CACHED_FILES];
+
+    make_cache_key(source, &key);
+    cached_files(outputs, files, made);
+    sprintf(header, "%s %lx %lx %ld", CACHE_MAGIC, key.first, key.second, key.length);
+
+    init_file_buffer(&entry);
+    append_string_to_buffer(&entry, header);
+    for (i = 0; i < CACHED_FILES; i++)
+    {
+        sprintf(header, " %ld", (*made[i]) ? files[i]->length : -1L);
+        append_string_to_buffer(&entry, header);
+    }
+    sprintf(header, " %ld\n", diagnostic_records()->length);
+    append_string_to_buffer(&entry, header);
+    for (i = 0; i < CACHED_FILES; i++)
+        if (*made[i])
+            append_to_buffer(&entry, files[i]->data, files[i]->length);
+    append_to_buffer(&entry, diagnostic_records()->data, diagnostic_records()->length);
+
+    name = cache_entry_name(&key);
+    temp_name = (char *) malloc(strlen(name) + MAX_LABEL_LENGTH);
+    sprintf(temp_name, "%s.%ld", name, (long) getpid());
+    if (!write_file_buffer(&entry, temp_name) || rename(temp_name, name) != 0)
+        remove(temp_name);
+    else if (cache_total < 0 || (cache_total += entry.length) > options.cache_limit)
+        trim_cache();
+
+    free(temp_name);
+    free(name);
+    free_file_buffer(&entry);
+}
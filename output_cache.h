@@ -0,0 +1,19 @@
+#ifndef OUTPUT_CACHE
+#define OUTPUT_CACHE
+
+#include "file_buffer.h"
+#include "output.h"
+
+typedef struct cache_key
+{
+    unsigned long first; /* First hash of the options and source */
+    unsigned long second; /* Second, independent hash of the options and source */
+    long length; /* Length of the source */
+} cache_key;
+
+void make_cache_key(file_buffer * source, cache_key * key);
+char * cache_entry_name(cache_key * key);
+int load_cached_outputs(file_buffer * source, output_files * outputs);
+void store_cached_outputs(file_buffer * source, output_files * outputs);
+
+#endif
@@ -0,0 +1,53 @@
+/*
+This file holds functions to deal correctly with the data structure (linked list) that holds relocations.
+A relocation is a code word whose address field holds the absolute address of a label of the file (la, call, jmp).
+When the code is placed at another base address, only the words in this list need to change.
+Later it will be put into an output file.
+*/
+
+#include "relocation_data_structure.h"
+
+relocation_row_ptr relocation_head, relocation_tail;
+
+void init_relocation_table()
+{
+    relocation_head = (relocation_row_ptr)malloc(sizeof(relocation_row));
+    relocation_tail = relocation_head;
+    relocation_tail->next = NULL;
+}
+
+void insert_relocation(int address, int section)
+{
+    /* Initialize new row*/
+    relocation_row_ptr new_row = (relocation_row_ptr)malloc(sizeof(relocation_row));
+
+    new_row->address = address;
+    new_row->section = section;
+
+    new_row->next = NULL;
+    relocation_tail->next = new_row;
+    relocation_tail = new_row;
+}
+
+void get_relocation_head(relocation_row_ptr* ptrhead)
+{
+	/* returning head->next since first node is not used (dummy) */
+    (*ptrhead) = (relocation_head->next);
+}
+
+void get_relocation_head_to_free(relocation_row_ptr* ptrhead)
+{
+    (*ptrhead) = relocation_head;
+}
+
+void free_relocation_table(relocation_row_ptr * head)
+{
+    relocation_row_ptr tmp;
+
+    while ((*head) != NULL)
+    {
+        tmp = (*head);
+        (*head) = (*head)->next;
+        free(tmp);
+    }
+}
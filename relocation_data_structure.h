@@ -0,0 +1,28 @@
+#ifndef RELOCATION_DATA_STRUCTURE
+#define RELOCATION_DATA_STRUCTURE
+
+#include "stdlib.h"
+#include "string.h"
+#include "stdio.h"
+#include "constants.h"
+
+enum{CODE_SECTION, DATA_SECTION}; /* Sections a relocated address can point into */
+
+typedef struct relocation_code * relocation_row_ptr;
+typedef struct relocation_code
+{
+    int address; /* The address of the code word that holds an absolute address of a label */
+    int section; /* The section of the label - CODE_SECTION or DATA_SECTION */
+    relocation_row_ptr next; /* Pointer to the next relocation struct */
+
+} relocation_row;
+
+extern relocation_row_ptr relocation_head, relocation_tail; /* Initialize relocation head & tail */
+
+void init_relocation_table();
+void insert_relocation(int address, int section);
+void get_relocation_head(relocation_row_ptr* ptrhead);
+void get_relocation_head_to_free(relocation_row_ptr* ptrhead);
+void free_relocation_table(relocation_row_ptr* ptrhead);
+
+#endif
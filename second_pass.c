@@ -1,13 +1,15 @@
 #include "second_pass.h"
 #include "second_pass_utils.h"
 #include "constants.h"
+#include "tokenizer.h"
+#include "diagnostics.h"
 
 int secondLineNumber = 1;
-int second_pass(FILE * file){
+int second_pass(file_buffer * source){
     int retval = 1;
     char line[MAX_LINE_LENGTH + 1];
     secondLineNumber = 1;
-    while (fgets(line, sizeof(line), file)){
+    while (!diagnostics_stopped() && buffer_get_line(source, line, sizeof(line))){
         if (!second_pass_analyze_line(line))
             retval = ERROR;
         secondLineNumber++;
@@ -16,36 +18,41 @@ int second_pass(FILE * file){
     return retval;
 }
 
-int second_pass_analyze_line(char* line)
-{
-    int retval = 1, i = 0;
-    if(next_char(line, &i) && line[i] != ';')  /* not an empty line or comment */
-    {
-        skip_label(line, &i);
-        next_char(line, &i);
-        if (line[i] == '.'){
-            i++;
-            retval = second_pass_directive_check(line, &i);
+/*
+ * Goes over the file again only to check the labels used as operands (for the --check option).
+ * Returns 1 if all of them are valid, 0 otherwise.
+ */
+int check_pass(file_buffer * source){
+    int retval = 1, k;
+    char line[MAX_LINE_LENGTH + 1];
+    token_line tokens;
+    secondLineNumber = 1;
+    while (!diagnostics_stopped() && buffer_get_line(source, line, sizeof(line))){
+        if (tokenize_line(line, &tokens)) {
+            k = tokens.tokens[0].type == TOKEN_LABEL_DEF;
+            if (!second_pass_check_labels(line, &tokens, k))
+                retval = ERROR;
         }
-        else
-            retval = second_pass_instructive_check(line, &i);
+        secondLineNumber++;
     }
+
     return retval;
 }
 
-/*
- * Reads an label (in the beginning of a command line).
- * Returns 1 if label is valid, 0 otherwise. Prints error messages if needed.
- */
-void skip_label(char* line, int* p)
+int second_pass_analyze_line(char* line)
 {
-    int i = (*p);       /* j - index in la, i index in line*/
-    if(isalpha(line[i])){
-        while(isalpha(line[i]) || isdigit(line[i]))
-            i++;
-        if(line[i++] == ':')
-            *p = i;
+    int retval = 1, k = 0; /* k - index of the mnemonic or directive in the tokens */
+    token_line tokens;
+    if(tokenize_line(line, &tokens))  /* not an empty line or comment */
+    {
+        if (tokens.tokens[k].type == TOKEN_LABEL_DEF)
+            k++;
+        if (tokens.tokens[k].type == TOKEN_DIRECTIVE)
+            retval = second_pass_directive_check(line, &tokens, k);
+        else
+            retval = second_pass_instructive_check(line, &tokens, k);
     }
+    return retval;
 }
 
 int second_get_line_number()
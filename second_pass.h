@@ -1,11 +1,11 @@
 #ifndef SECOND_PASS
 #define SECOND_PASS
 
-#include <ctype.h>
 #include <stdio.h>
+#include "file_buffer.h"
 
-void skip_label(char* line, int* p);
 int second_pass_analyze_line(char* line);
-int second_pass(FILE * file);
+int second_pass(file_buffer * source);
+int check_pass(file_buffer * source);
 
 #endif
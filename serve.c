@@ -0,0 +1,315 @@
+/*
+This file holds the server mode of the assembler (--serve socket) and the client that runs through it.
+A build that runs the assembler once for every source starts a new process and grows the tables of the
+assembler again every time. With "assembler --serve socket" a server listens on a Unix domain socket, and an
+assembler started while the environment variable ASSEMBLER_SOCKET names that socket doesn't analyze the files
+itself - it sends its working directory and its arguments to the server, writes what the server answers to its
+standard output, and exits with the exit status of the run. So existing build rules run through the server
+without any change, and if no server answers, the client analyzes the files itself.
+The server runs the requests on a pool of worker processes (--workers N), which accept connections on the same
+socket. The state of the assembler is global (IC, DC, the tables and the options), so the workers are processes
+and not threads - every worker runs one request at a time, and keeps its tables, pools and rows from one request
+to the next instead of freeing them. A worker that stops (on a crash, for example) is replaced.
+A request is the number of arguments, the working directory and the arguments, each terminated by '\0'.
+The answer is the output of the run, a '\0', and the exit status of the run as a decimal number.
+The -w and --serve options run until they are stopped, so runs with them are never sent to a server.
+*/
+
+#define _POSIX_C_SOURCE 200112L /* For sockets, fork, sigaction and chdir */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <signal.h>
+#include "serve.h"
+#include "options.h"
+#include "utils.h"
+
+#define SERVER_BACKLOG 64 /* Number of connections waiting for a worker before new ones are refused */
+#define MAX_NUMBER_LENGTH 32 /* Upper bound for the length of a number written as text */
+
+volatile sig_atomic_t stop_serving = 0; /* Set when the server is asked to stop */
+
+void stop_server(int signal_number)
+{
+    stop_serving = 1;
+}
+
+/* Writes all of the given bytes to a socket. Returns 1 on success, 0 otherwise */
+int write_all(int socket_descriptor, char * bytes, long length)
+{
+    long written;
+
+    while (length > 0)
+    {
+        if ((written = write(socket_descriptor, bytes, length)) <= 0)
+            return 0;
+        bytes += written;
+        length -= written;
+    }
+    return 1;
+}
+
+/* Fills the address of a socket. Returns 1 on success, 0 if the name of the socket is too long */
+int socket_address(char * socket_name, struct sockaddr_un * address)
+{
+    if (strlen(socket_name) >= sizeof(address->sun_path))
+        return 0;
+    memset(address, 0, sizeof(struct sockaddr_un));
+    address->sun_family = AF_UNIX;
+    strcpy(address->sun_path, socket_name);
+    return 1;
+}
+
+/* Returns a socket connected to the server at the given socket, or -1 if no server answers there */
+int connect_to_server(char * socket_name)
+{
+    struct sockaddr_un address;
+    int server;
+
+    if (!socket_address(socket_name, &address) || (server = socket(AF_UNIX, SOCK_STREAM, 0)) < 0)
+        return -1;
+    if (connect(server, (struct sockaddr *) &address, sizeof(address)) != 0)
+    {
+        close(server);
+        return -1;
+    }
+    return server;
+}
+
+/*
+ * Returns 1 if the options of a run keep it running until it is stopped (-w or --serve), 0 otherwise.
+ * Such a run is never sent to a server.
+ */
+int runs_until_stopped(int argc, char *argv[])
+{
+    int i;
+
+    for (i = 1; i < argc; i++)
+        if (!strcmp(argv[i], "-w") || !strcmp(argv[i], "--serve"))
+            return 1;
+    return 0;
+}
+
+/*
+ * Reads a request (until the client shuts its side of the connection) into request,
+ * and points args at its arguments - args[0] is the name of the program - and directory at its working directory.
+ * Returns the number of arguments (with the name of the program), or 0 if the request isn't valid.
+ */
+int read_request(int client, file_buffer * request, char *** args, char ** directory)
+{
+    char chunk[BUFSIZ], * next, * end;
+    long length, count;
+    int i;
+
+    while ((length = read(client, chunk, sizeof(chunk))) > 0 && request->length + length <= MAX_REQUEST_LENGTH)
+        append_to_buffer(request, chunk, length);
+    /* an error, a timeout, or a request that is too long */
+    if (length != 0 || request->length == 0 || request->data[request->length - 1] != '\0')
+        return 0;
+    end = request->data + request->length;
+    count = strtol(request->data, &next, 10);
+    if (*next != '\0' || count < 1 || count > request->length)
+        return 0;
+    (*directory) = next + 1;
+    next = (*directory) + strlen(*directory) + 1;
+    (*args) = (char **) malloc((count + 1) * sizeof(char *));
+    (*args)[0] = "assembler";
+    for (i = 1; i < count && next < end; i++)
+    {
+        (*args)[i] = next;
+        next += strlen(next) + 1;
+    }
+    (*args)[i] = NULL;
+    return (i == count && next == end) ? count : 0;
+}
+
+/*
+ * Runs a single request of a client with run, writing the output of the run to the client, and then its exit status.
+ * The options are set back to their defaults first, and the working directory of the worker is the one of the client.
+ */
+void serve_request(int client, int (*run)(int, char **))
+{
+    file_buffer request;
+    char ** args = NULL, * directory, answer[MAX_NUMBER_LENGTH];
+    int count, status = EXIT_FAILURE, saved_output;
+    struct timeval timeout;
+
+    /* a client that never finishes its request doesn't hold the worker */
+    timeout.tv_sec = REQUEST_TIMEOUT_SECONDS;
+    timeout.tv_usec = 0;
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    init_file_buffer(&request);
+    count = read_request(client, &request, &args, &directory);
+
+    /* everything the run prints goes to the client */
+    fflush(stdout);
+    saved_output = dup(STDOUT_FILENO);
+    dup2(client, STDOUT_FILENO);
+    if (count == 0)
+        printf("The request to the server is not valid\n");
+    else if (runs_until_stopped(count, args))
+        printf("The -w and --serve options can't be sent to a server\n");
+    else if (chdir(directory) != 0)
+        printf("Couldn't enter directory %s\n", directory);
+    else
+    {
+        reset_options();
+        status = run(count, args);
+    }
+    fflush(stdout);
+    dup2(saved_output, STDOUT_FILENO);
+    close(saved_output);
+
+    answer[0] = '\0';
+    sprintf(answer + 1, "%d", status);
+    write_all(client, answer, 1 + strlen(answer + 1));
+    free(args);
+    free_file_buffer(&request);
+}
+
+/* Starts a worker that serves requests from the listening socket until it is stopped. Returns its process id */
+pid_t start_worker(int listener, int (*run)(int, char **))
+{
+    int client;
+    pid_t pid = fork();
+
+    if (pid != 0)
+        return pid;
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+    while (1)
+    {
+        if ((client = accept(listener, NULL, NULL)) < 0)
+            continue;
+        serve_request(client, run);
+        close(client);
+    }
+}
+
+/*
+ * Serves runs of the assembler on a Unix domain socket with a pool of workers, each running requests with run
+ * (which analyzes the files given by the arguments of a run, and returns its exit status).
+ * Runs until the server is stopped by SIGINT or SIGTERM, and then stops the workers and removes the socket.
+ * Returns the exit status of the server.
+ */
+int serve(char * socket_name, int workers, int (*run)(int, char **))
+{
+    struct sockaddr_un address;
+    struct sigaction action;
+    struct stat status;
+    int listener, i, server;
+    pid_t * pids, pid;
+
+    if (!socket_address(socket_name, &address))
+    {
+        printf("The socket name %s is too long\n", socket_name);
+        return EXIT_FAILURE;
+    }
+    if ((server = connect_to_server(socket_name)) >= 0)
+    {
+        close(server);
+        printf("A server is already running on socket %s\n", socket_name);
+        return EXIT_FAILURE;
+    }
+    /* a socket left by a server that was killed is replaced, but no other kind of file is */
+    if (stat(socket_name, &status) == 0 && S_ISSOCK(status.st_mode))
+        unlink(socket_name);
+    if ((listener = socket(AF_UNIX, SOCK_STREAM, 0)) < 0
+        || bind(listener, (struct sockaddr *) &address, sizeof(address)) != 0 || listen(listener, SERVER_BACKLOG) != 0)
+    {
+        printf("Couldn't serve on socket %s\n", socket_name);
+        return EXIT_FAILURE;
+    }
+
+    /* a client that goes away only fails the writes to it */
+    signal(SIGPIPE, SIG_IGN);
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = stop_server;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    /* the workers start with the tables already made */
+    init_data_structures();
+    free_data_structures();
+
+    pids = (pid_t *) malloc(workers * sizeof(pid_t));
+    for (i = 0; i < workers; i++)
+        pids[i] = start_worker(listener, run);
+    printf("serving on %s with %d workers...\n", socket_name, workers);
+    fflush(stdout);
+    while (!stop_serving)
+    {
+        if ((pid = wait(NULL)) < 0)
+            continue;
+        for (i = 0; i < workers; i++)
+            if (pids[i] == pid && !stop_serving)
+                pids[i] = start_worker(listener, run);
+    }
+
+    for (i = 0; i < workers; i++)
+        if (pids[i] > 0)
+            kill(pids[i], SIGTERM);
+    while (wait(NULL) > 0)
+        ;
+    close(listener);
+    unlink(socket_name);
+    free(pids);
+    return 0;
+}
+
+/*
+ * Sends a run to the server at the given socket, and writes its output to the standard output.
+ * Returns the exit status of the run, or -1 if no server answers (and the run should be done here).
+ */
+int forward_to_server(char * socket_name, int argc, char *argv[])
+{
+    char directory[FILENAME_MAX], chunk[BUFSIZ], number[MAX_NUMBER_LENGTH], * end;
+    int server, i, sent, answered = 0, status = 0;
+    long length, k;
+    file_buffer request;
+
+    if (getcwd(directory, sizeof(directory)) == NULL || (server = connect_to_server(socket_name)) < 0)
+        return -1;
+    init_file_buffer(&request);
+    sprintf(number, "%d", argc);
+    append_to_buffer(&request, number, strlen(number) + 1);
+    append_to_buffer(&request, directory, strlen(directory) + 1);
+    for (i = 1; i < argc; i++)
+        append_to_buffer(&request, argv[i], strlen(argv[i]) + 1);
+    sent = write_all(server, request.data, request.length);
+    free_file_buffer(&request);
+    /* the server runs nothing before it has the whole request, so a request that wasn't sent is run here */
+    if (!sent || shutdown(server, SHUT_WR) != 0)
+    {
+        close(server);
+        return -1;
+    }
+
+    while ((length = read(server, chunk, sizeof(chunk))) > 0)
+    {
+        k = 0;
+        if (!answered)
+        {
+            end = (char *) memchr(chunk, '\0', length);
+            k = (end == NULL) ? length : end - chunk;
+            fwrite(chunk, 1, k, stdout);
+            answered = (end != NULL);
+            k += answered;
+        }
+        for (; k < length; k++)
+            if (chunk[k] >= '0' && chunk[k] <= '9')
+                status = 10 * status + (chunk[k] - '0');
+    }
+    close(server);
+    if (!answered)
+    {
+        printf("The server stopped before the run ended\n");
+        return EXIT_FAILURE;
+    }
+    return status;
+}
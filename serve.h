@@ -0,0 +1,14 @@
+#ifndef SERVE
+#define SERVE
+
+#include "file_buffer.h"
+
+#define SERVER_SOCKET_VARIABLE "ASSEMBLER_SOCKET" /* Environment variable naming the socket of a running server */
+#define MAX_REQUEST_LENGTH 1048576 /* Longest request a server reads - the directory and the arguments of a run */
+#define REQUEST_TIMEOUT_SECONDS 10 /* Time a server waits for the rest of a request before dropping it */
+
+int serve(char * socket_name, int workers, int (*run)(int, char **));
+int runs_until_stopped(int argc, char *argv[]);
+int forward_to_server(char * socket_name, int argc, char *argv[]);
+
+#endif
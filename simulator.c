@@ -0,0 +1,384 @@
+/*
+This file is the simulator - it runs an image made by the assembler (or by the linker).
+Usage: simulator [-n max_steps] [-q] name
+name is given as to the assembler, and its .ob file is read. A name that ends with .obj is read as a binary
+object file instead (assembled with -f bin).
+The memory is flat and little endian, as big as the 25 bit address field of a J instructive. The code is placed
+at the base address of the image, and the data right after it. Every code word is decoded once, before running,
+into an operation with its fields already taken apart (and the index of the operation a branch or a jump goes to),
+so running an instructive is a single switch on its kind. A store into the code decodes the words it changed again.
+The run ends at stop. Running past the end of the code, jumping outside of it, an access outside of the memory,
+an unknown word, or running more than max_steps instructives stop the run with an error.
+At the end the number of instructives run and the registers that are not 0 are printed (only with an error if -q).
+Every instructive runs as the course booklet (C project instructions.pdf) describes it - mvhi and mvlo, like lb and lh,
+change only the half (or byte) of the register they move into, blt and bgt compare signed registers, and la and call
+write $0 (the address of the label, and the address of the instructive after the call).
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "constants.h"
+#include "file_buffer.h"
+#include "object_reader.h"
+
+#define MEMORY_SIZE (1L << 25) /* Size of the memory - every address of a J instructive */
+#define NUMBER_OF_REGISTERS 32
+#define MASK_WORD 0xFFFFFFFFUL
+#define DEFAULT_MAX_STEPS 1000000000L
+
+/* Kinds of operations - one for every instructive, and more for the ways an instructive can't run */
+enum{OP_ADD, OP_SUB, OP_AND, OP_OR, OP_NOR, OP_MOVE, OP_MVHI, OP_MVLO, OP_ADDI, OP_SUBI, OP_ANDI, OP_ORI, OP_NORI,
+    OP_BNE, OP_BEQ, OP_BLT, OP_BGT, OP_LB, OP_SB, OP_LW, OP_SW, OP_LH, OP_SH, OP_JMP, OP_JMP_REGISTER, OP_LA,
+    OP_CALL, OP_STOP, OP_OUT_OF_CODE, OP_END, OP_ILLEGAL};
+
+/* Results of a run */
+enum{RUN_STOPPED, RUN_ERROR, RUN_TOO_LONG};
+
+/* A decoded code word */
+typedef struct operation
+{
+    unsigned char kind;
+    unsigned char rs, rt, rd; /* Registers of the instructive (rs holds the register of a jmp to a register) */
+    long immed; /* Sign extended immed, the address of a J instructive */
+    long target; /* Index of the operation a branch or a jump goes to */
+} operation;
+
+typedef struct machine
+{
+    unsigned char * memory;
+    unsigned long registers[NUMBER_OF_REGISTERS];
+    operation * code; /* One operation for every code word, and an OP_END operation after them */
+    long base; /* Address of the first code word */
+    long code_count; /* Number of code words */
+    long steps; /* Number of instructives run */
+} machine;
+
+/* Returns a 32 bit word as a signed number */
+long signed_word(unsigned long word)
+{
+    word &= MASK_WORD;
+    return (word & 0x80000000UL) ? -(long) (MASK_WORD - word) - 1 : (long) word;
+}
+
+/* Returns the index of the operation of the code word at address, or -1 if there is no code word there */
+long code_index(machine * m, long address)
+{
+    if (address < m->base || address >= m->base + 4 * m->code_count || (address - m->base) % 4 != 0)
+        return -1;
+    return (address - m->base) / 4;
+}
+
+/* Decodes the code word at the given index into its operation */
+void decode_word(machine * m, long index)
+{
+    long address = m->base + 4 * index;
+    unsigned char * bytes = m->memory + address;
+    unsigned long word = (unsigned long) bytes[0] | ((unsigned long) bytes[1] << 8) |
+                         ((unsigned long) bytes[2] << 16) | ((unsigned long) bytes[3] << 24);
+    int opcode = (int) (word >> 26), funct = (int) (word >> 6) & 0x1F;
+    operation * op = &m->code[index];
+
+    op->rs = (unsigned char) ((word >> 21) & 0x1F);
+    op->rt = (unsigned char) ((word >> 16) & 0x1F);
+    op->rd = (unsigned char) ((word >> 11) & 0x1F);
+    op->immed = signed_word((word & 0x8000UL) ? word | ~MASK_16_BITS : word & MASK_16_BITS);
+    op->target = -1;
+    op->kind = OP_ILLEGAL;
+
+    if (opcode == 0 && funct >= 1 && funct <= 5)
+        op->kind = OP_ADD + funct - 1;
+    else if (opcode == 1 && funct >= 1 && funct <= 3)
+        op->kind = OP_MOVE + funct - 1;
+    else if (opcode >= 10 && opcode <= 24)
+    {
+        op->kind = OP_ADDI + opcode - 10;
+        if (op->kind >= OP_BNE && op->kind <= OP_BGT)
+        {
+            /* the immed of a branch is the distance from the branch to its label */
+            op->target = code_index(m, address + op->immed);
+            if (op->target == -1)
+                op->kind = OP_OUT_OF_CODE;
+        }
+    }
+    else if (opcode == 30 || opcode == 31 || opcode == 32)
+    {
+        op->immed = (long) (word & 0x1FFFFFFUL);
+        if (opcode == 30 && (word & (1UL << 25)))
+        {
+            op->kind = OP_JMP_REGISTER;
+            op->rs = (unsigned char) (op->immed & 0x1F);
+        }
+        else if (opcode == 31)
+            op->kind = OP_LA;
+        else
+        {
+            op->kind = opcode == 30 ? OP_JMP : OP_CALL;
+            op->target = code_index(m, op->immed);
+            if (op->target == -1)
+                op->kind = OP_OUT_OF_CODE;
+        }
+    }
+    else if (opcode == 63)
+        op->kind = OP_STOP;
+}
+
+/* Decodes again the code words in the size bytes from address, after a store */
+void store_into_code(machine * m, long address, int size)
+{
+    long first = (address - m->base) / 4, last = (address + size - 1 - m->base) / 4;
+
+    if (address + size <= m->base || address >= m->base + 4 * m->code_count)
+        return;
+    if (first < 0)
+        first = 0;
+    if (last >= m->code_count)
+        last = m->code_count - 1;
+    for (; first <= last; first++)
+        decode_word(m, first);
+}
+
+/* Returns the little endian value of size bytes at address */
+unsigned long load_memory(machine * m, long address, int size)
+{
+    unsigned long value = 0;
+
+    while (size--)
+        value = (value << 8) | m->memory[address + size];
+    return value;
+}
+
+/* Writes the size least significant bytes of value at address, little endian */
+void store_memory(machine * m, long address, int size, unsigned long value)
+{
+    int i;
+
+    for (i = 0; i < size; i++, value >>= 8)
+        m->memory[address + i] = (unsigned char) value;
+    store_into_code(m, address, size);
+}
+
+/* Prints an error of the run at the instructive at the given index */
+void run_error(machine * m, long index, char * message)
+{
+    printf("error at address %ld: %s\n", m->base + 4 * index, message);
+}
+
+/* Runs from the first code word until stop, an error, or max_steps instructives. Returns the result of the run */
+int run_machine(machine * m, long max_steps)
+{
+    unsigned long * r = m->registers;
+    operation * op;
+    long pc = 0, address;
+    int size;
+    unsigned long mask;
+
+    for (m->steps = 0; m->steps < max_steps; m->steps++)
+    {
+        op = &m->code[pc];
+        switch (op->kind)
+        {
+            case OP_ADD: r[op->rd] = (r[op->rs] + r[op->rt]) & MASK_WORD; break;
+            case OP_SUB: r[op->rd] = (r[op->rs] - r[op->rt]) & MASK_WORD; break;
+            case OP_AND: r[op->rd] = r[op->rs] & r[op->rt]; break;
+            case OP_OR: r[op->rd] = r[op->rs] | r[op->rt]; break;
+            case OP_NOR: r[op->rd] = ~(r[op->rs] | r[op->rt]) & MASK_WORD; break;
+            case OP_MOVE: r[op->rd] = r[op->rs]; break;
+            case OP_MVHI: r[op->rd] = (r[op->rd] & 0xFFFF0000UL) | (r[op->rs] >> 16); break;
+            case OP_MVLO: r[op->rd] = (r[op->rd] & 0xFFFFUL) | ((r[op->rs] & 0xFFFFUL) << 16); break;
+            case OP_ADDI: r[op->rt] = (r[op->rs] + (unsigned long) op->immed) & MASK_WORD; break;
+            case OP_SUBI: r[op->rt] = (r[op->rs] - (unsigned long) op->immed) & MASK_WORD; break;
+            case OP_ANDI: r[op->rt] = r[op->rs] & (unsigned long) op->immed & MASK_WORD; break;
+            case OP_ORI: r[op->rt] = (r[op->rs] | (unsigned long) op->immed) & MASK_WORD; break;
+            case OP_NORI: r[op->rt] = ~(r[op->rs] | (unsigned long) op->immed) & MASK_WORD; break;
+            case OP_BNE:
+                if (r[op->rs] != r[op->rt])
+                {
+                    pc = op->target;
+                    continue;
+                }
+                break;
+            case OP_BEQ:
+                if (r[op->rs] == r[op->rt])
+                {
+                    pc = op->target;
+                    continue;
+                }
+                break;
+            case OP_BLT:
+                if (signed_word(r[op->rs]) < signed_word(r[op->rt]))
+                {
+                    pc = op->target;
+                    continue;
+                }
+                break;
+            case OP_BGT:
+                if (signed_word(r[op->rs]) > signed_word(r[op->rt]))
+                {
+                    pc = op->target;
+                    continue;
+                }
+                break;
+            case OP_LB: case OP_SB: case OP_LW: case OP_SW: case OP_LH: case OP_SH:
+                size = (op->kind == OP_LB || op->kind == OP_SB) ? 1 : (op->kind == OP_LW || op->kind == OP_SW) ? 4 : 2;
+                address = signed_word(r[op->rs]) + op->immed;
+                if (address < 0 || address > MEMORY_SIZE - size)
+                {
+                    run_error(m, pc, "memory access outside of the memory");
+                    return RUN_ERROR;
+                }
+                if (op->kind == OP_SB || op->kind == OP_SW || op->kind == OP_SH)
+                {
+                    store_memory(m, address, size, r[op->rt]);
+                    break;
+                }
+                /* lb and lh load into the low 8 or 16 bits of rt, and the other bits of rt are kept */
+                mask = (size == 4) ? MASK_WORD : (1UL << (8 * size)) - 1;
+                r[op->rt] = (r[op->rt] & ~mask & MASK_WORD) | load_memory(m, address, size);
+                break;
+            case OP_JMP:
+                pc = op->target;
+                continue;
+            case OP_JMP_REGISTER:
+                if ((address = code_index(m, signed_word(r[op->rs]))) == -1)
+                {
+                    run_error(m, pc, "jump outside of the code");
+                    return RUN_ERROR;
+                }
+                pc = address;
+                continue;
+            case OP_LA: r[0] = (unsigned long) op->immed; break;
+            case OP_CALL:
+                r[0] = (unsigned long) (m->base + 4 * pc + 4); /* the return address */
+                pc = op->target;
+                continue;
+            case OP_STOP:
+                m->steps++;
+                return RUN_STOPPED;
+            case OP_OUT_OF_CODE:
+                run_error(m, pc, "branch or jump outside of the code");
+                return RUN_ERROR;
+            case OP_END:
+                run_error(m, pc, "ran past the end of the code");
+                return RUN_ERROR;
+            default:
+                run_error(m, pc, "unknown instructive");
+                return RUN_ERROR;
+        }
+        pc++;
+    }
+    return RUN_TOO_LONG;
+}
+
+/* Places the code and data of the image in a new memory, and decodes the code. Returns 1 on success, 0 otherwise */
+int load_machine(machine * m, object_image * image)
+{
+    long i;
+
+    memset(m, 0, sizeof(machine));
+    if (image->base + image->code_size + image->data_size > (unsigned long) MEMORY_SIZE)
+        return 0;
+    m->base = (long) image->base;
+    m->code_count = (long) image->code_size / 4;
+    m->memory = (unsigned char *) calloc(MEMORY_SIZE, 1);
+    m->code = (operation *) malloc((m->code_count + 1) * sizeof(operation));
+    if (m->memory == NULL || m->code == NULL)
+        return 0;
+    memcpy(m->memory + m->base, image->code, image->code_size);
+    memcpy(m->memory + m->base + image->code_size, image->data, image->data_size);
+    for (i = 0; i < m->code_count; i++)
+        decode_word(m, i);
+    m->code[m->code_count].kind = OP_END;
+    return 1;
+}
+
+void free_machine(machine * m)
+{
+    free(m->memory);
+    free(m->code);
+}
+
+/* Reads the image of name - its .ob file, or the binary object file if name ends with .obj. Returns 1 if valid */
+int load_image(char * name, file_buffer * buffer, object_image * image)
+{
+    int length = strlen(name), valid;
+    char * file_name;
+
+    if (length > 4 && !strcmp(name + length - 4, ".obj"))
+    {
+        if (!load_file_buffer(buffer, name))
+        {
+            printf("error: cannot read %s\n", name);
+            return 0;
+        }
+        if (!open_object_image(image, (unsigned char *) buffer->data, buffer->length))
+        {
+            printf("error: %s is not a valid object file\n", name);
+            return 0;
+        }
+        image->bytes = NULL; /* the image is inside the buffer, and is freed with it */
+        return 1;
+    }
+
+    file_name = (char *) malloc(length + strlen(".ob") + 1);
+    strcpy(file_name, name);
+    strcat(file_name, ".ob");
+    valid = load_file_buffer(buffer, file_name);
+    if (!valid)
+        printf("error: cannot read %s\n", file_name);
+    else if ((valid = read_text_object(image, buffer)) == TEXT_OBJECT_NO_MEMORY)
+        printf("error: out of memory for the image of %s\n", file_name);
+    else if (!valid)
+        printf("error: %s is not a valid object file\n", file_name);
+    free(file_name);
+    return valid == 1;
+}
+
+int main(int argc, char *argv[])
+{
+    int i, quiet = 0, result = RUN_ERROR;
+    long max_steps = DEFAULT_MAX_STEPS;
+    file_buffer buffer;
+    object_image image;
+    machine m;
+
+    for (i = 1; i < argc - 1 && argv[i][0] == '-'; i++)
+    {
+        if (!strcmp(argv[i], "-n") && i + 2 < argc)
+            max_steps = strtol(argv[++i], NULL, 10);
+        else if (!strcmp(argv[i], "-q"))
+            quiet = 1;
+        else
+            break;
+    }
+    if (i != argc - 1 || max_steps <= 0)
+    {
+        printf("Usage: simulator [-n max_steps] [-q] name\n");
+        return 1;
+    }
+
+    init_file_buffer(&buffer);
+    memset(&image, 0, sizeof(object_image));
+    if (load_image(argv[i], &buffer, &image))
+    {
+        if (!load_machine(&m, &image))
+            printf("error: the image of %s doesn't fit in the memory\n", argv[i]);
+        else
+        {
+            result = run_machine(&m, max_steps);
+            if (result == RUN_TOO_LONG)
+                printf("error: stopped after %ld instructives without reaching stop\n", m.steps);
+            if (!quiet || result != RUN_STOPPED)
+            {
+                printf("%ld instructives run\n", m.steps);
+                for (i = 0; i < NUMBER_OF_REGISTERS; i++)
+                    if (m.registers[i] != 0)
+                        printf("$%d = %ld\n", i, signed_word(m.registers[i]));
+            }
+        }
+        free_machine(&m);
+    }
+    free(image.bytes);
+    free_file_buffer(&buffer);
+    return result == RUN_STOPPED ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+/*
+This file holds the pool of .asciz strings of the file being analyzed, used with the --pool-strings option.
+The first pass adds every labeled string to the pool along with the offset of its copy in the data image,
+and a later labeled string with the same contents gets the offset of that copy instead of a copy of its own.
+With --pool-strings suffix, every suffix of a string in the pool is found too, at the offset where it starts
+inside the copy of the string - so a later "lo" shares the copy of "hello".
+The second pass finds every labeled string again, and adds it to the data image only at the offset of its copy.
+The strings are kept one after another in a single array, and are found through an open addressing hash table
+of places in that array, so a suffix takes a slot of the table but no characters of its own.
+The pool is emptied between files, and its memory is kept for the next file.
+*/
+
+#include "string_pool.h"
+#include "symbol_hash.h"
+
+#define INITIAL_STRING_SLOTS 512 /* Number of slots of the hash table on its first allocation, a power of 2 */
+#define INITIAL_STRING_TEXT 4096 /* Number of characters the pool has room for on its first allocation */
+#define NO_STRING -1
+
+typedef struct pooled_string
+{
+    long text; /* Offset of the string in string_pool_text, NO_STRING for an empty slot */
+    long offset; /* Offset of the copy of the string in the data image */
+} pooled_string;
+
+char * string_pool_text = NULL; /* The strings, one after another, each terminated by '\0' */
+long string_pool_length = 0, string_pool_capacity = 0;
+pooled_string * string_slots = NULL; /* The hash table */
+long string_slot_count = 0, string_count = 0; /* string_count - number of used slots, at most half of the slots */
+
+void init_string_pool()
+{
+    long i;
+
+    if (string_slots != NULL)
+        return;
+    string_slot_count = INITIAL_STRING_SLOTS;
+    string_slots = (pooled_string *) malloc(string_slot_count * sizeof(pooled_string));
+    for (i = 0; i < string_slot_count; i++)
+        string_slots[i].text = NO_STRING;
+    string_pool_capacity = INITIAL_STRING_TEXT;
+    string_pool_text = (char *) malloc(string_pool_capacity);
+}
+
+/* Returns the slot of a string in the hash table - its own slot, or the empty slot it belongs to */
+long find_string_slot(char * string)
+{
+    long slot = hash_string(string) & (string_slot_count - 1);
+
+    while (string_slots[slot].text != NO_STRING && strcmp(string_pool_text + string_slots[slot].text, string))
+        slot = (slot + 1) & (string_slot_count - 1);
+    return slot;
+}
+
+/* Doubles the slots of the hash table, and puts every string in its slot again */
+void grow_string_pool()
+{
+    pooled_string * old_slots = string_slots;
+    long old_count = string_slot_count, i;
+
+    string_slot_count *= 2;
+    string_slots = (pooled_string *) malloc(string_slot_count * sizeof(pooled_string));
+    for (i = 0; i < string_slot_count; i++)
+        string_slots[i].text = NO_STRING;
+    for (i = 0; i < old_count; i++)
+        if (old_slots[i].text != NO_STRING)
+            string_slots[find_string_slot(string_pool_text + old_slots[i].text)] = old_slots[i];
+    free(old_slots);
+}
+
+/* Adds the string at the given place of the pool text to the hash table, unless an equal string is there already */
+void add_string_slot(long text, long offset)
+{
+    long slot;
+
+    if (2 * (string_count + 1) > string_slot_count)
+        grow_string_pool();
+    slot = find_string_slot(string_pool_text + text);
+    if (string_slots[slot].text != NO_STRING)
+        return;
+    string_slots[slot].text = text;
+    string_slots[slot].offset = offset;
+    string_count++;
+}
+
+/*
+ * Returns the offset of the copy of a string in the data image. If the string isn't in the pool,
+ * it is added with the given offset (and, if suffixes is 1, every suffix of it too), and offset is returned.
+ */
+long pool_string(char * string, long offset, int suffixes)
+{
+    long slot, length = strlen(string), text, i;
+
+    init_string_pool();
+    slot = find_string_slot(string);
+    if (string_slots[slot].text != NO_STRING)
+        return string_slots[slot].offset;
+
+    while (string_pool_length + length + 1 > string_pool_capacity)
+    {
+        string_pool_capacity *= 2;
+        string_pool_text = (char *) realloc(string_pool_text, string_pool_capacity);
+    }
+    text = string_pool_length;
+    memcpy(string_pool_text + text, string, length + 1);
+    string_pool_length += length + 1;
+    /* the suffix of length 0 is the terminating '\0', which an empty string can share */
+    for (i = 0; i <= (suffixes ? length : 0); i++)
+        add_string_slot(text + i, offset + i);
+    return offset;
+}
+
+/* Returns the offset of the copy of a string in the data image, or -1 if it isn't in the pool */
+long find_pooled_string(char * string)
+{
+    long slot;
+
+    if (string_count == 0)
+        return NO_STRING;
+    slot = find_string_slot(string);
+    return string_slots[slot].text == NO_STRING ? NO_STRING : string_slots[slot].offset;
+}
+
+void reset_string_pool()
+{
+    /* Empties the pool for the next file, keeping its memory */
+    long i;
+
+    for (i = 0; i < string_slot_count; i++)
+        string_slots[i].text = NO_STRING;
+    string_count = 0;
+    string_pool_length = 0;
+}
+
+void release_string_pool()
+{
+    free(string_pool_text);
+    free(string_slots);
+    string_pool_text = NULL;
+    string_slots = NULL;
+    string_pool_length = 0;
+    string_pool_capacity = 0;
+    string_slot_count = 0;
+    string_count = 0;
+}
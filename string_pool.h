@@ -0,0 +1,13 @@
+#ifndef STRING_POOL
+#define STRING_POOL
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+long pool_string(char * string, long offset, int suffixes);
+long find_pooled_string(char * string);
+void reset_string_pool();
+void release_string_pool();
+
+#endif
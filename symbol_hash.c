@@ -0,0 +1,106 @@
+/*
+This file holds a hash table of symbols, used to find symbols by their name in constant time
+when there are too many of them to search through a list (e.g. the symbols of all the modules being linked).
+The table grows as symbols are inserted, so it stays fast for any number of symbols.
+*/
+
+#include "symbol_hash.h"
+
+#define INITIAL_BUCKETS 256 /* Number of buckets of a new table */
+#define MAX_LOAD 2 /* The table grows when it holds more than MAX_LOAD symbols per bucket */
+
+/* FNV-1a hash of a string */
+unsigned long hash_string(char * text)
+{
+    unsigned long hash = 2166136261UL;
+
+    while (*text != '\0')
+        hash = ((hash ^ (unsigned char) *text++) * 16777619UL) & 0xFFFFFFFFUL;
+    return hash;
+}
+
+void init_symbol_hash(symbol_hash * table)
+{
+    table->bucket_count = INITIAL_BUCKETS;
+    table->count = 0;
+    table->buckets = (hash_symbol_ptr *) calloc(table->bucket_count, sizeof(hash_symbol_ptr));
+}
+
+/* Doubles the number of buckets, and moves every symbol to its new bucket */
+void grow_symbol_hash(symbol_hash * table)
+{
+    long i, bucket_count = table->bucket_count * 2;
+    hash_symbol_ptr * buckets = (hash_symbol_ptr *) calloc(bucket_count, sizeof(hash_symbol_ptr));
+    hash_symbol_ptr row, next;
+
+    if (buckets == NULL)
+        return;
+    for (i = 0; i < table->bucket_count; i++)
+    {
+        for (row = table->buckets[i]; row != NULL; row = next)
+        {
+            next = row->next;
+            row->next = buckets[hash_string(row->symbol) & (bucket_count - 1)];
+            buckets[hash_string(row->symbol) & (bucket_count - 1)] = row;
+        }
+    }
+    free(table->buckets);
+    table->buckets = buckets;
+    table->bucket_count = bucket_count;
+}
+
+/* Returns the symbol with the given name, NULL if it isn't in the table */
+hash_symbol_ptr find_hash_symbol(symbol_hash * table, char * symbol)
+{
+    hash_symbol_ptr row = table->buckets[hash_string(symbol) & (table->bucket_count - 1)];
+
+    while (row != NULL && strcmp(row->symbol, symbol))
+        row = row->next;
+    return row;
+}
+
+/*
+ * Inserts a symbol to the table, if there is no symbol with the same name.
+ * Returns the symbol that was already in the table, or NULL if the new symbol was inserted.
+ */
+hash_symbol_ptr insert_hash_symbol(symbol_hash * table, char * symbol, long value, int owner)
+{
+    hash_symbol_ptr row = find_hash_symbol(table, symbol);
+    long bucket;
+
+    if (row != NULL)
+        return row;
+    if (table->count >= table->bucket_count * MAX_LOAD)
+        grow_symbol_hash(table);
+
+    row = (hash_symbol_ptr) malloc(sizeof(hash_symbol));
+    row->symbol = (char *) malloc(strlen(symbol) + 1);
+    strcpy(row->symbol, symbol);
+    row->value = value;
+    row->owner = owner;
+
+    bucket = hash_string(symbol) & (table->bucket_count - 1);
+    row->next = table->buckets[bucket];
+    table->buckets[bucket] = row;
+    table->count++;
+    return NULL;
+}
+
+void free_symbol_hash(symbol_hash * table)
+{
+    long i;
+    hash_symbol_ptr row, next;
+
+    for (i = 0; i < table->bucket_count; i++)
+    {
+        for (row = table->buckets[i]; row != NULL; row = next)
+        {
+            next = row->next;
+            free(row->symbol);
+            free(row);
+        }
+    }
+    free(table->buckets);
+    table->buckets = NULL;
+    table->count = 0;
+}
@@ -0,0 +1,30 @@
+#ifndef SYMBOL_HASH
+#define SYMBOL_HASH
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+typedef struct hash_symbol * hash_symbol_ptr;
+typedef struct hash_symbol
+{
+    char * symbol; /* Name of the symbol (a copy owned by the table) */
+    long value; /* Value of the symbol */
+    int owner; /* Index of the file / module the symbol belongs to */
+    hash_symbol_ptr next; /* Next symbol in the same bucket */
+} hash_symbol;
+
+typedef struct symbol_hash
+{
+    hash_symbol_ptr * buckets; /* Array of bucket lists */
+    long bucket_count; /* Number of buckets, always a power of 2 */
+    long count; /* Number of symbols in the table */
+} symbol_hash;
+
+unsigned long hash_string(char * text);
+void init_symbol_hash(symbol_hash * table);
+hash_symbol_ptr find_hash_symbol(symbol_hash * table, char * symbol);
+hash_symbol_ptr insert_hash_symbol(symbol_hash * table, char * symbol, long value, int owner);
+void free_symbol_hash(symbol_hash * table);
+
+#endif
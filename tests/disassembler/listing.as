@@ -0,0 +1,13 @@
+; entries and an external label, for the listing of the disassembler
+        .entry LOOP
+        .entry NUMBER
+        .extern PRINT
+MAIN:   addi $0, 10, $1
+LOOP:   subi $1, 1, $1
+        bne $1, $0, LOOP
+        la NUMBER
+        lw $0, 0, $4
+        call PRINT
+        stop
+NUMBER: .dw 1234
+TEXT:   .asciz "ab"
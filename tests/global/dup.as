@@ -0,0 +1,5 @@
+; declares PRINT of util.as again, and uses a label with no entry
+.entry PRINT
+.extern NOWHERE
+PRINT:  la NOWHERE
+        stop
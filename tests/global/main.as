@@ -0,0 +1,4 @@
+; uses a label of util.as, which fails after its first pass
+MAIN:   call PRINT
+        stop
+.extern PRINT
@@ -0,0 +1,4 @@
+; PRINT is an entry, but the file fails its first pass
+.entry PRINT
+PRINT:  add $1, $2
+        stop
@@ -0,0 +1,10 @@
+; doubles a word of its data, and loads a halfword of the data of util.as
+        .extern DOUBLE
+        .extern TABLE
+MAIN:   la NUMBER
+        lw $0, 0, $4
+        call DOUBLE
+        la TABLE
+        lh $0, 2, $6
+        stop
+NUMBER: .dw 1234
@@ -0,0 +1,6 @@
+; the entries used by main.as
+        .entry DOUBLE
+        .entry TABLE
+DOUBLE: add $4, $4, $5
+        jmp $0
+TABLE:  .dh 7, 8
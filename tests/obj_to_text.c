@@ -0,0 +1,91 @@
+/*
+This program converts a binary object file (.obj, see object_format.h) back to the text output files of the assembler -
+the .ob file, and the .ent and .ext files when there are entries and externals - written as prefix.ob, prefix.ent
+and prefix.ext. It is used by run_tests.sh to check that the two formats hold the same program.
+*/
+
+#include "../object_reader.h"
+#include "../file_buffer.h"
+#include "../constants.h"
+
+/* Appends a new line of the .ob file for address, if a line starts there */
+void start_ob_line(file_buffer * output, unsigned long address)
+{
+    char text[MAX_LINE_LENGTH];
+
+    if (address % 4 == 0)
+    {
+        sprintf(text, "\n0%lu ", address);
+        append_string_to_buffer(output, text);
+    }
+}
+
+/* Writes the output file prefix.extension, or nothing if the buffer is empty. Returns 1 on success, 0 otherwise */
+int write_text_file(file_buffer * output, char * prefix, char * extension)
+{
+    char name[FILENAME_MAX];
+    int retval = 1;
+
+    if (output->length > 0)
+    {
+        sprintf(name, "%.*s%s", (int) (sizeof(name) - strlen(extension) - 1), prefix, extension);
+        retval = write_file_buffer(output, name);
+    }
+    free_file_buffer(output);
+    return retval;
+}
+
+int main(int argc, char *argv[])
+{
+    file_buffer input, ob, ent, ext;
+    object_image image;
+    unsigned long i, address, value;
+    char text[MAX_LINE_LENGTH * 2], * name;
+
+    if (argc != 3)
+    {
+        printf("Usage: obj_to_text object_file prefix\n");
+        return 1;
+    }
+    if (!load_file_buffer(&input, argv[1]) || !open_object_image(&image, (unsigned char *) input.data, input.length))
+    {
+        printf("Couldn't read object file %s\n", argv[1]);
+        return 1;
+    }
+    init_file_buffer(&ob);
+    init_file_buffer(&ent);
+    init_file_buffer(&ext);
+
+    /* the code bytes and then the data bytes, 4 on a line, as print_code_hex and print_data_hex print them */
+    sprintf(text, "     %lu %lu     ", image.code_size, image.data_size);
+    append_string_to_buffer(&ob, text);
+    address = image.base;
+    for (i = 0; i < image.code_size + image.data_size; i++, address++)
+    {
+        start_ob_line(&ob, address);
+        sprintf(text, "%02X ", i < image.code_size ? image.code[i] : image.data[i - image.code_size]);
+        append_string_to_buffer(&ob, text);
+    }
+    start_ob_line(&ob, address);
+
+    for (i = 0; i < image.entry_count; i++)
+    {
+        name = object_entry(&image, i, &value);
+        sprintf(text, "%s 0%lu\n", name != NULL ? name : "?", value);
+        append_string_to_buffer(&ent, text);
+    }
+    for (i = 0; i < image.extern_count; i++)
+    {
+        name = object_extern(&image, i, &value);
+        sprintf(text, "%s 0%lu\n", name != NULL ? name : "?", value);
+        append_string_to_buffer(&ext, text);
+    }
+    free_file_buffer(&input);
+    if (!write_text_file(&ob, argv[2], ".ob") || !write_text_file(&ent, argv[2], ".ent") ||
+        !write_text_file(&ext, argv[2], ".ext"))
+    {
+        printf("Couldn't write the text files of %s\n", argv[2]);
+        return 1;
+    }
+    return 0;
+}
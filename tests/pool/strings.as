@@ -0,0 +1,12 @@
+; loads bytes of a string, of the same string, and of its suffix
+MAIN:   la FIRST
+        lb $0, 4, $1
+        la SECOND
+        lb $0, 4, $2
+        la SUFFIX
+        lb $0, 0, $3
+        sub $0, $0, $0
+        stop
+FIRST:  .asciz "hello"
+SECOND: .asciz "hello"
+SUFFIX: .asciz "llo"
@@ -0,0 +1,221 @@
+#!/bin/sh
+# Checks of the assembler and its tools, run by "make check" from the directory of the makefile.
+# Every check prints a line with its result, and the script fails if any check failed.
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+failed=0
+assembler=$(pwd)/assembler
+simulator=$(pwd)/simulator
+disassembler=$(pwd)/disassembler
+linker=$(pwd)/linker
+
+pass() { echo "ok   $1"; }
+fail() { echo "FAIL $1"; failed=1; }
+
+# The binary object file holds the same program as the text output files: every sample is assembled
+# in both formats, and the .obj file converted back to text must equal the .ob, .ent and .ext files
+for source in tests/samples/*.as; do
+    name=$(basename "$source")
+    mkdir -p "$work/text" "$work/bin"
+    cp "$source" "$work/text/$name"
+    cp "$source" "$work/bin/$name"
+    "$assembler" "$work/text/$name" > /dev/null
+    "$assembler" -f bin "$work/bin/$name" > /dev/null
+    if [ ! -f "$work/text/$name.ob" ] || ! tests/obj_to_text "$work/bin/$name.obj" "$work/bin/$name.obj" > /dev/null; then
+        fail "round trip of $name - not assembled"
+        continue
+    fi
+    same=1
+    for extension in ob ent ext; do
+        if [ -f "$work/text/$name.$extension" ] || [ -f "$work/bin/$name.obj.$extension" ]; then
+            cmp -s "$work/text/$name.$extension" "$work/bin/$name.obj.$extension" || same=0
+        fi
+    done
+    if [ $same = 1 ]; then pass "round trip of $name"; else fail "round trip of $name - the .obj differs from the text files"; fi
+done
+
+# With -g, the entries and externals of all the files are checked together, and errors fail the run.
+# util.as fails its first pass, but its entry is still known, so the external of main.as is resolved
+mkdir -p "$work/global"
+cp tests/global/*.as "$work/global"
+if (cd "$work/global" && "$assembler" -g main.as util.as 2>&1) | grep -q "is not an entry"; then
+    fail "global index - an entry of a file that failed is missing"
+else
+    pass "global index - entries of a file that failed"
+fi
+output=$(cd "$work/global" && "$assembler" -g main.as util.as dup.as 2>&1)
+status=$?
+if [ $status -ne 0 ] && echo "$output" | grep -q "entry PRINT is declared in util.as and in dup.as" &&
+   echo "$output" | grep -q "NOWHERE declared in dup.as is not an entry"; then
+    pass "global index - errors fail the run"
+else
+    fail "global index - errors fail the run (exit status $status)"
+fi
+output=$(cd "$work/global" && "$assembler" -g --diagnostics machine main.as util.as dup.as 2>&1)
+if echo "$output" | grep -q "^dup.as:2:8:error:duplicate-entry:" &&
+   echo "$output" | grep -q "^dup.as:3:9:error:unresolved-extern:"; then
+    pass "global index - errors at their declarations with --diagnostics machine"
+else
+    fail "global index - errors at their declarations with --diagnostics machine"
+fi
+
+# The code and data must fit below address 33554431, the highest address a J instructive holds:
+# data that ends exactly there is assembled, and la gets the full address, but one more byte is an error
+mkdir -p "$work/range"
+printf 'MAIN: la C\nA: .space 16777216\nB: .fill 4194277, 4, 1\nC: .fill 1, 4, 7\n' > "$work/range/fit.as"
+cp "$work/range/fit.as" "$work/range/over.as"
+printf '.db 1\n' >> "$work/range/over.as"
+# an included file is checked the same way
+head -c 16777216 /dev/zero > "$work/range/zero.bin"
+printf 'MAIN: la C\nA: .incbin "zero.bin"\nB: .incbin "zero.bin"\nC: .db 1\n' > "$work/range/include.as"
+(cd "$work/range" && "$assembler" include.as > include.txt)
+"$assembler" "$work/range/fit.as" "$work/range/over.as" > "$work/range/out.txt"
+if grep -q "^0100 FC FF FF 7D" "$work/range/fit.as.ob" && [ ! -f "$work/range/over.as.ob" ] &&
+   grep -q "no room" "$work/range/out.txt" && [ ! -f "$work/range/include.as.ob" ] &&
+   grep -q "line 3: error: no room" "$work/range/include.txt"; then
+    pass "address range of the code and data"
+else
+    fail "address range of the code and data"
+fi
+
+# A source taken from the cache (-c) shows the same warnings as when it was analyzed
+mkdir -p "$work/cache/entries"
+printf 'X: .extern Y\n\tjmp Y\n\tstop\n' > "$work/cache/warn.as"
+(cd "$work/cache" && "$assembler" -c entries warn.as > first.txt && "$assembler" -c entries warn.as > second.txt)
+if grep -q "warning" "$work/cache/first.txt" && cmp -s "$work/cache/first.txt" "$work/cache/second.txt"; then
+    pass "warnings of a cached source"
+else
+    fail "warnings of a cached source"
+fi
+
+# Once the cache goes over --cache-limit, the least recently used entries are removed: a is used again
+# after b, so c replaces b and not a
+mkdir -p "$work/lru/entries"
+for name in a b c; do printf "$name: .db 1\n" > "$work/lru/$name.as"; done
+(cd "$work/lru" && "$assembler" -c entries a.as > /dev/null)
+a_entry=$(ls "$work/lru/entries")
+(cd "$work/lru" && "$assembler" -c entries b.as > /dev/null)
+b_entry=$(ls "$work/lru/entries" | grep -v "$a_entry")
+touch -d "2 hours ago" "$work/lru/entries/$a_entry" "$work/lru/entries/$b_entry"
+(cd "$work/lru" && "$assembler" -c entries a.as > /dev/null)
+size=$(wc -c < "$work/lru/entries/$a_entry")
+(cd "$work/lru" && "$assembler" -c entries --cache-limit $((size * 5 / 2)) c.as > /dev/null)
+if [ -f "$work/lru/entries/$a_entry" ] && [ ! -f "$work/lru/entries/$b_entry" ] &&
+   [ $(ls "$work/lru/entries" | wc -l) -eq 2 ]; then
+    pass "least recently used cache entries are removed"
+else
+    fail "least recently used cache entries are removed"
+fi
+
+# A run sent to a server (--serve, with ASSEMBLER_SOCKET set) makes the same files and exit status as a run
+# of its own, and a list file that can't be read fails the run either way
+mkdir -p "$work/serve/local" "$work/serve/served"
+cp tests/samples/ps.as "$work/serve/local"
+cp tests/samples/ps.as "$work/serve/served"
+"$assembler" --serve "$work/serve/socket" --workers 2 > /dev/null &
+server=$!
+i=0
+while [ ! -S "$work/serve/socket" ] && [ $i -lt 50 ]; do sleep 0.1; i=$((i + 1)); done
+(cd "$work/serve/local" && "$assembler" ps.as > out.txt)
+(cd "$work/serve/served" && ASSEMBLER_SOCKET="$work/serve/socket" "$assembler" ps.as > out.txt)
+(cd "$work/serve/served" && ASSEMBLER_SOCKET="$work/serve/socket" "$assembler" @missing.txt > /dev/null)
+status=$?
+kill $server
+wait $server
+same=1
+for name in ps.as.ob ps.as.ent ps.as.ext out.txt; do
+    cmp -s "$work/serve/local/$name" "$work/serve/served/$name" || same=0
+done
+if [ $same = 1 ] && [ $status -ne 0 ] && [ ! -S "$work/serve/socket" ]; then
+    pass "runs sent to a server"
+else
+    fail "runs sent to a server"
+fi
+
+# The simulator runs a known program to its stop, and prints the instructives it ran and the registers it set
+mkdir -p "$work/simulator"
+cp tests/simulator/sum.as "$work/simulator"
+(cd "$work/simulator" && "$assembler" sum.as > /dev/null)
+output=$("$simulator" "$work/simulator/sum.as")
+expected='37 instructives run
+$0 = 128
+$3 = 55
+$4 = 1234
+$5 = 2468'
+if [ "$output" = "$expected" ]; then
+    pass "simulator runs a known program"
+else
+    fail "simulator runs a known program"
+fi
+
+# The listing of a known program names the addresses of its entries and its external labels,
+# and disassembles the code and the data back to their instructives and bytes
+mkdir -p "$work/disassembler"
+cp tests/disassembler/listing.as "$work/disassembler"
+(cd "$work/disassembler" && "$assembler" listing.as > /dev/null && "$disassembler" listing.as > /dev/null)
+cat > "$work/disassembler/expected.dis" << 'EOF'
+0100 2801000A  addi $0, 10, $1
+0104 2C210001  LOOP: subi $1, 1, $1
+0108 3C20FFFC  bne $1, $0, LOOP
+0112 7C000080  la NUMBER
+0116 54040000  lw $0, 0, $4
+0120 80000000  call PRINT
+0124 FC000000  stop
+0128           NUMBER: .db -46, 4, 0, 0
+0132           .db 97, 98, 0
+EOF
+if cmp -s "$work/disassembler/listing.as.dis" "$work/disassembler/expected.dis"; then
+    pass "disassembler lists a known program"
+else
+    fail "disassembler lists a known program"
+fi
+
+# Linking two modules places the code of both and then the data of both, so the linked image equals
+# the image of a single file with both of them, and the simulator runs it through the external labels
+mkdir -p "$work/link"
+cp tests/link/main.as tests/link/util.as "$work/link"
+grep -v "\.extern" tests/link/main.as > "$work/link/whole.as"
+cat tests/link/util.as >> "$work/link/whole.as"
+(cd "$work/link" && "$assembler" -r main.as util.as > /dev/null && "$linker" linked main.as util.as > /dev/null &&
+ "$assembler" whole.as > /dev/null)
+output=$("$simulator" "$work/link/linked")
+expected='8 instructives run
+$0 = 136
+$4 = 1234
+$5 = 2468
+$6 = 8'
+if cmp -s "$work/link/linked.ob" "$work/link/whole.as.ob" && [ "$output" = "$expected" ]; then
+    pass "linker links two modules"
+else
+    fail "linker links two modules"
+fi
+
+# Pooled strings share the bytes of a string that is the same as another (same), or the end of another (suffix):
+# the data image is smaller, and the program loads the same bytes as a build without pooling
+mkdir -p "$work/pool/none" "$work/pool/same" "$work/pool/suffix"
+runs=""
+sizes=""
+for pooling in none same suffix; do
+    cp tests/pool/strings.as "$work/pool/$pooling"
+    if [ $pooling = none ]; then
+        (cd "$work/pool/$pooling" && "$assembler" strings.as > /dev/null)
+    else
+        (cd "$work/pool/$pooling" && "$assembler" --pool-strings $pooling strings.as > /dev/null)
+    fi
+    runs="$runs$("$simulator" "$work/pool/$pooling/strings.as")
+"
+    sizes="$sizes $(head -1 "$work/pool/$pooling/strings.as.ob" | awk '{ print $2 }')"
+done
+expected='8 instructives run
+$1 = 111
+$2 = 111
+$3 = 108
+'
+if [ "$runs" = "$expected$expected$expected" ] && [ "$sizes" = " 16 10 6" ]; then
+    pass "pooled strings load the same bytes"
+else
+    fail "pooled strings load the same bytes"
+fi
+
+exit $failed
@@ -0,0 +1,38 @@
+; every instruction
+.extern EX
+.entry S1
+A1:	add $1,$2,$3
+	sub $4 , $5 , $6
+	and $7,$8,$9
+	or $10,$11,$12
+	nor $13,$14,$15
+	move $16,$17
+	mvhi $18,$19
+	mvlo $20,$21
+	addi $1,+32767,$2
+	subi $1,-32768,$2
+	andi $1,0,$2
+	ori $1,7,$2
+	nori $1,-7,$2
+	bne $1,$2,A1
+	beq $1,$2,END
+	blt $3,$4,S1
+	bgt $5,$6,A1
+	lb $1,4,$2
+	sb $1,-4,$2
+	lw $1,8,$2
+	sw $1,12,$2
+	lh $1,16,$2
+	sh $1,20,$2
+	jmp A1
+	jmp $31
+	la S1
+	call EX
+	jmp EX
+END:	stop
+S1:	.asciz "he said \"hi\", ok"
+S2: .asciz ""
+N1:	.db 127,-127, 0 ,+5
+N2:	.dh 32767 , -32767
+N3:	.dw 2147483647,-2147483647
+.entry N3
@@ -0,0 +1,12 @@
+; sums 1 to 10 into $3, and doubles a word of the data into $5
+MAIN:   addi $0, 10, $1
+LOOP:   add $3, $1, $3
+        subi $1, 1, $1
+        bne $1, $0, LOOP
+        la NUMBER
+        lw $0, 0, $4
+        call DOUBLE
+        stop
+DOUBLE: add $4, $4, $5
+        jmp $0
+NUMBER: .dw 1234
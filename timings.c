@@ -0,0 +1,70 @@
+/*
+This file measures the time spent in every stage of analyzing the files, for the --timings option.
+The stages run one after another for every file - the source is read, the first pass checks it and fills the
+symbol table, the second pass encodes it, and the output files are made and written - so the stage with the
+largest share of the time is the one to make faster. The times are wall clock times, so the time a stage waits
+for the disk is counted too, and are summed over all the files. With --low-memory the source is read by the
+passes and the .ob file is written by the second pass, so their time is part of the time of the passes.
+This is only a measurement. The assembler has no pipeline of stages - there are no threads and no queues between
+the stages, a stage never runs while another one does, and the shares show where the time of a single thread goes.
+The only read ahead is prefetch_file, which asks the system to read the next source from the disk.
+*/
+
+#define _POSIX_C_SOURCE 200112L /* For clock_gettime */
+
+#include <stdio.h>
+#include <time.h>
+#include "timings.h"
+#include "options.h"
+
+char * stage_names[NUMBER_OF_STAGES] = {"read", "first pass", "second pass", "output"};
+double stage_times[NUMBER_OF_STAGES]; /* Seconds spent in every stage so far */
+double stage_start; /* Time the current stage started, in seconds */
+
+/* Returns the time in seconds, from a clock that is never set back */
+double monotonic_seconds()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/* Starts measuring a stage, which is ended by end_stage */
+void start_stage()
+{
+    if (options.timings)
+        stage_start = monotonic_seconds();
+}
+
+/* Adds the time since start_stage to the given stage */
+void end_stage(int stage)
+{
+    if (options.timings)
+        stage_times[stage] += monotonic_seconds() - stage_start;
+}
+
+/* Sets the time of every stage back to 0, before the files of another run are analyzed */
+void reset_timings()
+{
+    int stage;
+
+    for (stage = 0; stage < NUMBER_OF_STAGES; stage++)
+        stage_times[stage] = 0;
+}
+
+/* Prints the time of every stage, and its share of the total time */
+void print_timings(int files)
+{
+    int stage;
+    double total = 0;
+
+    if (!options.timings)
+        return;
+    for (stage = 0; stage < NUMBER_OF_STAGES; stage++)
+        total += stage_times[stage];
+    printf("timings of %d files - %.3f seconds\n", files, total);
+    for (stage = 0; stage < NUMBER_OF_STAGES; stage++)
+        printf("    %-12s %8.3f seconds %6.1f%%\n", stage_names[stage], stage_times[stage],
+               total > 0 ? 100.0 * stage_times[stage] / total : 0.0);
+}
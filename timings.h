@@ -0,0 +1,11 @@
+#ifndef TIMINGS
+#define TIMINGS
+
+enum{STAGE_READ, STAGE_FIRST_PASS, STAGE_SECOND_PASS, STAGE_OUTPUT, NUMBER_OF_STAGES}; /* Stages of analyzing a file */
+
+void start_stage();
+void end_stage(int stage);
+void reset_timings();
+void print_timings(int files);
+
+#endif
@@ -0,0 +1,167 @@
+/*
+This file turns a line of the source into an array of typed tokens, each with its place in the line.
+The line is read once, from left to right, and the tokens point into it instead of copying it,
+so nothing is allocated. The tokenizer doesn't check the syntax of the line - it only splits it,
+and characters that can't start any token are kept as TOKEN_OTHER tokens.
+The first pass checks the line from its tokens, and the second pass reads its operands from them,
+after the first pass made sure the line is valid.
+*/
+
+#include <limits.h>
+#include "tokenizer.h"
+
+/* Names of the instructives and directives, in the order of their values */
+char * instructive_names[NUMBER_OF_INSTRUCTIVES] = {"", "add", "sub", "and", "or", "nor", "move", "mvhi", "mvlo",
+    "addi", "subi", "andi", "ori", "nori", "bne", "beq", "blt", "bgt", "lb", "sb", "lw", "sw", "lh", "sh",
+    "jmp", "la", "call", "stop"};
+char * directive_names[EXTERN + 1] = {"", "db", "dw", "dh", "asciz", "space", "fill",
+    "incbin", "entry", "extern"};
+
+/*
+ * Returns the instructive named by the first length characters of name, ERR if there is no such instructive.
+ */
+int instructive_of(char * name, int length)
+{
+    int instructive;
+    for (instructive = ADD; instructive <= STOP; instructive++)
+        if (instructive_names[instructive][0] == name[0] && !strncmp(instructive_names[instructive], name, length)
+            && instructive_names[instructive][length] == '\0')
+            return instructive;
+    return ERR;
+}
+
+/*
+ * Returns the directive named by the first length characters of name, ERR if there is no such directive.
+ */
+int directive_of(char * name, int length)
+{
+    int directive;
+    for (directive = DB; directive <= EXTERN; directive++)
+        if (!strncmp(directive_names[directive], name, length) && directive_names[directive][length] == '\0')
+            return directive;
+    return ERR;
+}
+
+/* Returns value with the digit ch added after its digits, or LONG_MAX if that is too big for a long */
+long add_digit(long value, char ch)
+{
+    return (value > (LONG_MAX - (ch - '0')) / 10) ? LONG_MAX : 10 * value + (ch - '0');
+}
+
+/* Adds a token to the line, and returns it */
+token * add_token(token_line * tokens, int type, int start, int length)
+{
+    token * t = &tokens->tokens[tokens->count++];
+    t->type = type;
+    t->start = start;
+    t->length = length;
+    t->value = 0;
+    return t;
+}
+
+/*
+ * Splits the line into tokens. Returns the number of tokens, 0 for an empty line or a comment.
+ */
+int tokenize_line(char * line, token_line * tokens)
+{
+    int i = 0, start, end, keyword = 1; /* keyword - 1 while a mnemonic may still come */
+    char ch;
+    token * t;
+
+    tokens->count = 0;
+    while (IS_BLANK(ch = line[i]))
+        i++;
+    if (ch == ';')
+        return 0;
+    for (end = i; line[end] != '\0' && line[end] != '\n'; end++)
+        ;
+
+    while (i < end && tokens->count < MAX_TOKENS)
+    {
+        ch = line[i];
+        start = i;
+        if (IS_BLANK(ch))
+        {
+            i++;
+            continue;
+        }
+        if (IS_ALPHA(ch))
+        {
+            while (IS_LABEL_CHAR(line[i]))
+                i++;
+            if (line[i] == ':' && tokens->count == 0)
+            {
+                add_token(tokens, TOKEN_LABEL_DEF, start, i - start);
+                i++;
+                continue;
+            }
+            if (keyword)
+            {
+                t = add_token(tokens, TOKEN_MNEMONIC, start, i - start);
+                t->value = instructive_of(line + start, i - start);
+            }
+            else
+                add_token(tokens, TOKEN_IDENTIFIER, start, i - start);
+        }
+        else if (ch == '.' && IS_ALPHA(line[i + 1]))
+        {
+            i++;
+            while (IS_ALPHA(line[i]))
+                i++;
+            t = add_token(tokens, TOKEN_DIRECTIVE, start + 1, i - start - 1);
+            t->value = directive_of(line + start + 1, i - start - 1);
+        }
+        else if (ch == '$' && IS_DIGIT(line[i + 1]))
+        {
+            t = add_token(tokens, TOKEN_REGISTER, start, 0);
+            for (i++; IS_DIGIT(line[i]); i++)
+                t->value = add_digit(t->value, line[i]);
+            t->length = i - start;
+        }
+        else if (IS_DIGIT(ch) || ((ch == '-' || ch == '+') && IS_DIGIT(line[i + 1])))
+        {
+            t = add_token(tokens, TOKEN_INTEGER, start, 0);
+            if (ch == '-' || ch == '+')
+                i++;
+            for (; IS_DIGIT(line[i]); i++)
+                t->value = add_digit(t->value, line[i]);
+            if (ch == '-')
+                t->value = -t->value;
+            t->length = i - start;
+        }
+        else if (ch == '"')
+        {
+            /* the string ends at the last quote of the line, as the first pass reads it */
+            i = end - 1;
+            while (i > start && line[i] != '"')
+                i--;
+            if (i == start)
+                i = end;
+            add_token(tokens, TOKEN_STRING, start + 1, i - start - 1);
+            if (i < end)
+                i++;
+        }
+        else if (ch == ',')
+        {
+            add_token(tokens, TOKEN_COMMA, start, 1);
+            i++;
+        }
+        else
+        {
+            add_token(tokens, TOKEN_OTHER, start, 1);
+            i++;
+        }
+        keyword = 0;
+    }
+    return tokens->count;
+}
+
+/*
+ * Copies the text of a token into text, cutting it to size - 1 characters.
+ */
+void token_text(char * line, token * t, char * text, int size)
+{
+    int length = t->length < size - 1 ? t->length : size - 1;
+    memcpy(text, line + t->start, length);
+    text[length] = '\0';
+}
@@ -0,0 +1,39 @@
+#ifndef TOKENIZER
+#define TOKENIZER
+
+#include <string.h>
+#include "char_class.h"
+#include "constants.h"
+
+enum{ERR, ADD, SUB, AND, OR, NOR, MOVE, MVHI, MVLO, ADDI, SUBI, ANDI, ORI, NORI, BNE, BEQ,
+    BLT, BGT, LB, SB, LW, SW, LH, SH, JMP, LA, CALL, STOP};
+enum{DB = 1, DW, DH, ASCIZ, SPACE, FILL, INCBIN, ENTRY, EXTERN}; /* The data directives come first, DB to INCBIN */
+
+/* Types of tokens */
+enum{TOKEN_LABEL_DEF, TOKEN_MNEMONIC, TOKEN_DIRECTIVE, TOKEN_REGISTER, TOKEN_INTEGER, TOKEN_IDENTIFIER,
+    TOKEN_STRING, TOKEN_COMMA, TOKEN_OTHER};
+
+#define MAX_TOKENS MAX_LINE_LENGTH /* Every token takes at least one character of the line */
+
+typedef struct token
+{
+    int type;
+    int start; /* Index in the line of the first character of the token */
+    int length; /* Number of characters in the token, without the ':' of a label, the '.' of a directive and the quotes of a string */
+    long value; /* Instructive of a mnemonic, directive of a directive, number of a register or value of an integer */
+} token;
+
+typedef struct token_line
+{
+    token tokens[MAX_TOKENS];
+    int count;
+} token_line;
+
+extern char * instructive_names[NUMBER_OF_INSTRUCTIVES];
+
+int tokenize_line(char * line, token_line * tokens);
+void token_text(char * line, token * t, char * text, int size);
+int instructive_of(char * name, int length);
+int directive_of(char * name, int length);
+
+#endif
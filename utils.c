@@ -3,13 +3,21 @@ The file holds general util functions for the project - initiating and freeing d
 or dealing with global variables of the program.
 */
 
+#include "char_class.h"
 #include "utils.h"
+#include "first_pass.h"
+#include "second_pass.h"
+#include "output.h"
+#include "timings.h"
 
+int DC = 0;
+int IC = INITIAL_ADDRESS;
 
 void init_data_structures()
 {
 	init_binary_tables();
 	init_symbol_table();
+	init_relocation_table();
 }
 
 
@@ -18,6 +26,7 @@ void free_data_structures()
     code_row_ptr code_head;
 	row_ptr symbol_head;
 	external_row_ptr external_head;
+	relocation_row_ptr relocation_head;
     get_code_head_to_free(&code_head);
     free_binary_table(&code_head);
     get_data_head_to_free(&code_head);
@@ -26,6 +35,129 @@ void free_data_structures()
     free_symbol_table(&symbol_head);
 	get_external_head_to_free(&external_head);
     free_external_table(&external_head);
+	get_relocation_head_to_free(&relocation_head);
+	free_relocation_table(&relocation_head);
+	reset_intern_pool();
+	reset_string_pool();
+}
+
+/*
+ * Analyzes a source with both passes, and makes its output files into outputs if it is valid.
+ * With --low-memory the .ob file of file_name is streamed while the second pass runs instead (see open_output_stream),
+ * and is written only if the source is valid. The diagnostics are added to the current file (see start_diagnostics), and are not written.
+ * Every data structure is freed, and IC and DC are set back, before returning - so any number of sources can
+ * be assembled one after another, each from the same state.
+ * Returns 1 if the output files were made, 0 otherwise.
+ */
+int assemble_source(file_buffer * source, output_files * outputs, char * file_name)
+{
+    int ICF, DCF, retval = 0, valid;
+
+    init_data_structures();
+    IC = options.base_address;
+    DC = 0;
+    start_stage();
+    valid = first_pass(source);
+    end_stage(STAGE_FIRST_PASS);
+    if (valid)
+    {
+        ICF = IC;
+        DCF = DC;
+        set_section_bases(options.base_address, ICF);
+        IC = options.base_address;
+        DC = 0;
+        rewind_file_buffer(source);
+        start_stage();
+        valid = (!options.low_memory || open_output_stream(file_name, ICF - options.base_address, DCF)) &&
+                second_pass(source);
+        end_stage(STAGE_SECOND_PASS);
+        start_stage();
+        if (valid)
+        {
+            make_output_files(outputs, ICF - options.base_address, DCF);
+            retval = 1;
+        }
+        if (output_streamed() && !close_output_stream(retval))
+            retval = 0;
+        end_stage(STAGE_OUTPUT);
+    }
+    free_data_structures();
+    IC = options.base_address;
+    DC = 0;
+    return retval;
+}
+
+void release_data_structures()
+{
+    /* Frees the rows kept for reuse between files, after the last file was analyzed */
+    release_code_rows();
+    release_symbol_rows();
+    release_external_rows();
+    release_intern_pool();
+    release_string_pool();
+}
+
+/* Adds a name to the list of files, growing the list if it is full */
+void add_file_name(char ** names[], int * count, int * capacity, char * name)
+{
+    if ((*count) == (*capacity))
+    {
+        (*capacity) *= 2;
+        (*names) = (char **) realloc((*names), (*capacity) * sizeof(char *));
+    }
+    (*names)[(*count)++] = name;
+}
+
+/*
+ * Builds the list of files to analyze from the arguments.
+ * An argument of the form @list_file is replaced by the names written in list_file, separated by white spaces,
+ * so many files can be analyzed by a single run of the assembler.
+ * The names from list files point into lists, which must be kept until the names are not needed.
+ * found is set to 1 if every list file was read, 0 otherwise (the names of the other arguments are collected anyway).
+ * Returns the number of files in the list.
+ */
+int collect_file_names(int argc, char *argv[], char ** names[], file_buffer * lists, int * found)
+{
+    int i, count = 0, capacity = argc;
+    long k;
+    file_buffer * list;
+
+    (*names) = (char **) malloc(capacity * sizeof(char *));
+    (*found) = 1;
+    for (i = 0; i < argc; i++)
+        init_file_buffer(&lists[i]);
+    for (i = 1; i < argc; i++)
+    {
+        if (argv[i][0] != '@')
+        {
+            add_file_name(names, &count, &capacity, argv[i]);
+            continue;
+        }
+        list = &lists[i];
+        if (!load_file_buffer(list, argv[i] + 1))
+        {
+            printf("Couldn't open list file %s\n", argv[i] + 1);
+            (*found) = 0;
+            continue;
+        }
+        append_to_buffer(list, "", 1); /* terminates the last name */
+        for (k = 0; k < list->length; k++)
+        {
+            if (IS_SPACE(list->data[k]))
+                list->data[k] = '\0';
+            else if (list->data[k] != '\0' && (k == 0 || list->data[k - 1] == '\0'))
+                add_file_name(names, &count, &capacity, list->data + k);
+        }
+    }
+    return count;
+}
+
+void free_file_names(int argc, char ** names, file_buffer * lists)
+{
+    int i;
+    for (i = 0; i < argc; i++)
+        free_file_buffer(&lists[i]);
+    free(names);
 }
 
 int given_files(int n)
@@ -4,13 +4,24 @@
 #include "label_data_structure.h"
 #include "binary_data_structure.h"
 #include "external_data_structure.h"
+#include "relocation_data_structure.h"
+#include "intern_pool.h"
+#include "string_pool.h"
+#include "file_buffer.h"
 #include "constants.h"
 
+struct output_files; /* see output.h, which includes this file */
+
 extern int IC;
 extern int DC;
 
 void init_data_structures();
 void free_data_structures();
+void release_data_structures();
+int assemble_source(file_buffer * source, struct output_files * outputs, char * file_name);
+void add_file_name(char ** names[], int * count, int * capacity, char * name);
+int collect_file_names(int argc, char *argv[], char ** names[], file_buffer * lists, int * found);
+void free_file_names(int argc, char ** names, file_buffer * lists);
 int given_files(int);
 
 #endif
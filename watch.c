@@ -0,0 +1,108 @@
+/*
+This file holds the watch mode of the assembler (the -w option).
+After the files are analyzed once, their status is checked every WATCH_INTERVAL_MS milliseconds
+(or as often as --watch-interval sets), and a file is analyzed again as soon as its content changes. Only the changed file is analyzed again,
+and together with -u (which -w turns on) only the output files whose content changed are written.
+A new modification time (to the nanosecond) or size only causes the file to be read and hashed - a file that
+was saved with the same content (or just touched) is not analyzed again.
+*/
+
+#define _POSIX_C_SOURCE 200809L /* For stat with st_mtim, and nanosleep */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <time.h>
+#include "watch.h"
+#include "output_cache.h"
+#include "options.h"
+
+#define RECENT_SECONDS 2 /* A file with whole second times modified this recently is hashed even if its status didn't change */
+
+typedef struct watched_file
+{
+    char * name;
+    struct timespec modified; /* Modification time of the file when it was last read */
+    off_t size; /* Size of the file when it was last read */
+    cache_key key; /* Hash of the content of the file when it was last read */
+} watched_file;
+
+/*
+ * Reads a file and hashes its content into key. Returns 1 on success, 0 if the file couldn't be read.
+ */
+int hash_watched_file(char * name, cache_key * key)
+{
+    file_buffer source;
+
+    if (!load_file_buffer(&source, name))
+        return 0;
+    make_cache_key(&source, key);
+    free_file_buffer(&source);
+    return 1;
+}
+
+/*
+ * Checks if a watched file changed since it was last read, and keeps its new status and hash.
+ * The modification time and the size are compared, and the file is hashed only if one of them is new.
+ * A file system that keeps whole seconds only (no nanoseconds) can't tell two saves within a second apart,
+ * so a file with such a time that was modified in the last seconds is hashed even if its status is the same.
+ * Returns 1 if the content changed, 0 otherwise.
+ */
+int watched_file_changed(watched_file * file)
+{
+    struct stat status;
+    cache_key key;
+
+    if (stat(file->name, &status) != 0)
+        return 0; /* removed, or being replaced - checked again next time */
+    if (status.st_mtim.tv_sec == file->modified.tv_sec && status.st_mtim.tv_nsec == file->modified.tv_nsec
+        && status.st_size == file->size
+        && (status.st_mtim.tv_nsec != 0 || time(NULL) - status.st_mtim.tv_sec > RECENT_SECONDS))
+        return 0;
+    file->modified = status.st_mtim;
+    file->size = status.st_size;
+    if (!hash_watched_file(file->name, &key))
+        return 0;
+    if (key.first == file->key.first && key.second == file->key.second && key.length == file->key.length)
+        return 0;
+    file->key = key;
+    return 1;
+}
+
+/*
+ * Analyzes again every file whose content changes, using assemble (which analyzes a single file).
+ * Runs until the process is stopped.
+ */
+void watch_files(char ** names, int count, int (*assemble)(char *, char *))
+{
+    int i;
+    struct stat status;
+    struct timespec interval;
+    watched_file * files = (watched_file *) calloc(count, sizeof(watched_file));
+
+    interval.tv_sec = options.watch_interval / 1000;
+    interval.tv_nsec = (options.watch_interval % 1000) * 1000000L;
+    for (i = 0; i < count; i++)
+    {
+        files[i].name = names[i];
+        if (stat(names[i], &status) == 0)
+        {
+            files[i].modified = status.st_mtim;
+            files[i].size = status.st_size;
+        }
+        hash_watched_file(names[i], &files[i].key);
+    }
+    printf("watching %d files for changes...\n", count);
+    fflush(stdout);
+    while (1)
+    {
+        nanosleep(&interval, NULL);
+        for (i = 0; i < count; i++)
+        {
+            if (watched_file_changed(&files[i]))
+            {
+                assemble(files[i].name, NULL);
+                fflush(stdout);
+            }
+        }
+    }
+}
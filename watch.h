@@ -0,0 +1,8 @@
+#ifndef WATCH
+#define WATCH
+
+#include "file_buffer.h"
+
+void watch_files(char ** names, int count, int (*assemble)(char *, char *));
+
+#endif